@@ -17,7 +17,7 @@ Example:
 """
 
 import os
-from ctypes import CDLL, Structure, c_int, c_uint8, c_uint16, c_uint32, c_float, c_char, c_char_p, c_void_p, POINTER, byref
+from ctypes import CDLL, Structure, c_int, c_int32, c_uint8, c_uint16, c_uint32, c_uint64, c_float, c_char, c_char_p, c_void_p, POINTER, byref
 
 
 class PagerInput(Structure):
@@ -29,6 +29,88 @@ class PagerInput(Structure):
     ]
 
 
+class PagerOptions(Structure):
+    """Init options matching pager_options_t in C."""
+    _fields_ = [
+        ("calibrate_frames", c_int),  # > 0: time this many full-frame writes at init
+        ("display", c_char_p),        # "fb", "memory" or "file:<path>" (None: $PAGER_DISPLAY)
+        ("device_root", c_char_p),    # Prefix for /dev and /sys paths (None: $PAGER_ROOT)
+    ]
+
+
+class PagerCalibration(Structure):
+    """Display throughput matching pager_calibration_t in C."""
+    _fields_ = [
+        ("frame_us", c_uint32),       # Average time to present a full frame
+        ("row_call_us", c_uint32),    # Average time to present a single row
+        ("bytes_per_sec", c_uint32),  # Full-frame throughput
+        ("max_fps", c_uint32),        # Achievable full-frame rate
+    ]
+
+
+class PagerFlipStats(Structure):
+    """Flip counters matching pager_flip_stats_t in C."""
+    _fields_ = [
+        ("frames_presented", c_uint32),  # Flips that sent something to the display
+        ("rows_written", c_uint32),      # Scanlines sent (including merged gaps)
+        ("rows_skipped", c_uint32),      # Damaged scanlines dropped as unchanged
+        ("bytes_written", c_uint64),     # Bytes sent to the display
+        ("bytes_saved", c_uint64),       # Bytes not sent thanks to row differencing
+        ("frames_elided", c_uint32),     # Flips skipped because nothing changed
+    ]
+
+
+class PagerFrameInfo(Structure):
+    """Frame pacing report matching pager_frame_info_t in C."""
+    _fields_ = [
+        ("frame_us", c_uint32),        # Time between the last two frame_sync returns
+        ("late_us", c_int32),          # How far past its deadline the last frame arrived
+        ("frames", c_uint32),          # Frames paced since the last reset
+        ("frames_late", c_uint32),     # Frames that missed their deadline
+        ("frames_skipped", c_uint32),  # Frame slots dropped by FRAME_SKIP
+    ]
+
+
+class PagerPoint(Structure):
+    """Point matching pager_point_t in C."""
+    _fields_ = [
+        ("x", c_int),
+        ("y", c_int),
+    ]
+
+
+class PagerRect(Structure):
+    """Filled rectangle matching pager_rect_t in C."""
+    _fields_ = [
+        ("x", c_int),
+        ("y", c_int),
+        ("w", c_int),
+        ("h", c_int),
+        ("color", c_uint16),
+    ]
+
+
+class PagerLine(Structure):
+    """Line matching pager_line_t in C."""
+    _fields_ = [
+        ("x0", c_int),
+        ("y0", c_int),
+        ("x1", c_int),
+        ("y1", c_int),
+        ("color", c_uint16),
+    ]
+
+
+class PagerCircle(Structure):
+    """Circle matching pager_circle_t in C."""
+    _fields_ = [
+        ("cx", c_int),
+        ("cy", c_int),
+        ("r", c_int),
+        ("color", c_uint16),
+    ]
+
+
 class PagerInputEvent(Structure):
     """Input event structure for thread-safe event queue."""
     _fields_ = [
@@ -43,6 +125,9 @@ PAGER_EVENT_NONE = 0
 PAGER_EVENT_PRESS = 1
 PAGER_EVENT_RELEASE = 2
 
+# Mask background that leaves clear bits untouched
+PAGER_TRANSPARENT = -1
+
 # Find the shared library (portable - looks relative to this file first)
 _lib_paths = [
     os.path.join(os.path.dirname(os.path.abspath(__file__)), "libpagerctl.so"),
@@ -81,6 +166,14 @@ class Pager:
     ROTATION_180 = 180  # Portrait inverted
     ROTATION_270 = 270  # Landscape inverted (default)
 
+    # Render modes (for set_render_mode)
+    RENDER_DIRECT = 0   # Rotate every pixel as it is drawn (default)
+    RENDER_LOGICAL = 1  # Draw in logical orientation, rotate once per flip
+
+    # Frame pacing policies (for set_frame_policy)
+    FRAME_SKIP = 0     # Drop missed frames, stay on the frame grid (default)
+    FRAME_CATCHUP = 1  # Run late frames back-to-back to make up the time
+
     # Font sizes (for built-in bitmap font)
     FONT_SMALL = 1   # 5x7
     FONT_MEDIUM = 2  # 10x14
@@ -125,8 +218,12 @@ class Pager:
         # Init/cleanup
         _lib.pager_init.argtypes = []
         _lib.pager_init.restype = c_int
+        _lib.pager_init_ex.argtypes = [POINTER(PagerOptions)]
+        _lib.pager_init_ex.restype = c_int
         _lib.pager_cleanup.argtypes = []
         _lib.pager_cleanup.restype = None
+        _lib.pager_get_backend.argtypes = []
+        _lib.pager_get_backend.restype = c_char_p
 
         # Rotation
         _lib.pager_set_rotation.argtypes = [c_int]
@@ -135,10 +232,24 @@ class Pager:
         _lib.pager_get_width.restype = c_int
         _lib.pager_get_height.argtypes = []
         _lib.pager_get_height.restype = c_int
+        _lib.pager_push_clip.argtypes = [c_int, c_int, c_int, c_int]
+        _lib.pager_push_clip.restype = c_int
+        _lib.pager_pop_clip.argtypes = []
+        _lib.pager_pop_clip.restype = None
+        _lib.pager_reset_clip.argtypes = []
+        _lib.pager_reset_clip.restype = None
+        _lib.pager_get_clip.argtypes = [POINTER(c_int), POINTER(c_int), POINTER(c_int), POINTER(c_int)]
+        _lib.pager_get_clip.restype = c_int
+        _lib.pager_set_render_mode.argtypes = [c_int]
+        _lib.pager_set_render_mode.restype = c_int
+        _lib.pager_get_render_mode.argtypes = []
+        _lib.pager_get_render_mode.restype = c_int
 
         # Frame management
         _lib.pager_flip.argtypes = []
-        _lib.pager_flip.restype = None
+        _lib.pager_flip.restype = c_int
+        _lib.pager_get_generation.argtypes = []
+        _lib.pager_get_generation.restype = c_uint32
         _lib.pager_clear.argtypes = [c_uint16]
         _lib.pager_clear.restype = None
         _lib.pager_get_ticks.argtypes = []
@@ -147,6 +258,50 @@ class Pager:
         _lib.pager_delay.restype = None
         _lib.pager_frame_sync.argtypes = []
         _lib.pager_frame_sync.restype = c_uint32
+        _lib.pager_set_frame_policy.argtypes = [c_int]
+        _lib.pager_set_frame_policy.restype = None
+        _lib.pager_reset_frame_sync.argtypes = []
+        _lib.pager_reset_frame_sync.restype = None
+        _lib.pager_get_frame_info.argtypes = [POINTER(PagerFrameInfo)]
+        _lib.pager_get_frame_info.restype = None
+        _lib.pager_set_target_fps.argtypes = [c_int]
+        _lib.pager_set_target_fps.restype = None
+        _lib.pager_get_target_fps.argtypes = []
+        _lib.pager_get_target_fps.restype = c_int
+        _lib.pager_calibrate.argtypes = [c_int, POINTER(PagerCalibration)]
+        _lib.pager_calibrate.restype = c_int
+        _lib.pager_get_calibration.argtypes = [POINTER(PagerCalibration)]
+        _lib.pager_get_calibration.restype = c_int
+
+        # Row differencing / flip statistics
+        _lib.pager_set_row_diff.argtypes = [c_int]
+        _lib.pager_set_row_diff.restype = None
+        _lib.pager_get_row_diff.argtypes = []
+        _lib.pager_get_row_diff.restype = c_int
+        _lib.pager_get_flip_stats.argtypes = [POINTER(PagerFlipStats)]
+        _lib.pager_get_flip_stats.restype = None
+        _lib.pager_reset_flip_stats.argtypes = []
+        _lib.pager_reset_flip_stats.restype = None
+
+        # Asynchronous flip
+        _lib.pager_set_async_flip.argtypes = [c_int]
+        _lib.pager_set_async_flip.restype = c_int
+        _lib.pager_get_async_flip.argtypes = []
+        _lib.pager_get_async_flip.restype = c_int
+        _lib.pager_flip_fence.argtypes = []
+        _lib.pager_flip_fence.restype = c_uint32
+        _lib.pager_flip_wait.argtypes = [c_uint32, c_int]
+        _lib.pager_flip_wait.restype = c_int
+
+        # Damage tracking
+        _lib.pager_damage_rect.argtypes = [c_int, c_int, c_int, c_int]
+        _lib.pager_damage_rect.restype = None
+        _lib.pager_damage_all.argtypes = []
+        _lib.pager_damage_all.restype = None
+        _lib.pager_clear_damage.argtypes = []
+        _lib.pager_clear_damage.restype = None
+        _lib.pager_get_damage.argtypes = [POINTER(c_int), POINTER(c_int), POINTER(c_int), POINTER(c_int)]
+        _lib.pager_get_damage.restype = c_int
 
         # Drawing
         _lib.pager_set_pixel.argtypes = [c_int, c_int, c_uint16]
@@ -165,6 +320,44 @@ class Pager:
         _lib.pager_fill_circle.restype = None
         _lib.pager_draw_circle.argtypes = [c_int, c_int, c_int, c_uint16]
         _lib.pager_draw_circle.restype = None
+        _lib.pager_draw_line_aa.argtypes = [c_int, c_int, c_int, c_int, c_uint16]
+        _lib.pager_draw_line_aa.restype = None
+        _lib.pager_draw_circle_aa.argtypes = [c_int, c_int, c_int, c_uint16]
+        _lib.pager_draw_circle_aa.restype = None
+        _lib.pager_fill_ellipse.argtypes = [c_int, c_int, c_int, c_int, c_uint16]
+        _lib.pager_fill_ellipse.restype = None
+        _lib.pager_draw_ellipse.argtypes = [c_int, c_int, c_int, c_int, c_uint16]
+        _lib.pager_draw_ellipse.restype = None
+        _lib.pager_fill_round_rect.argtypes = [c_int, c_int, c_int, c_int, c_int, c_uint16]
+        _lib.pager_fill_round_rect.restype = None
+        _lib.pager_draw_round_rect.argtypes = [c_int, c_int, c_int, c_int, c_int, c_uint16]
+        _lib.pager_draw_round_rect.restype = None
+        _lib.pager_fill_vgradient.argtypes = [c_int, c_int, c_int, c_int, c_uint16, c_uint16]
+        _lib.pager_fill_vgradient.restype = None
+        _lib.pager_fill_hgradient.argtypes = [c_int, c_int, c_int, c_int, c_uint16, c_uint16]
+        _lib.pager_fill_hgradient.restype = None
+        _lib.pager_scroll_region.argtypes = [c_int, c_int, c_int, c_int, c_int, c_int, c_uint16]
+        _lib.pager_scroll_region.restype = None
+        _lib.pager_fill_rect_alpha.argtypes = [c_int, c_int, c_int, c_int, c_uint16, c_uint8]
+        _lib.pager_fill_rect_alpha.restype = None
+        _lib.pager_hline_alpha.argtypes = [c_int, c_int, c_int, c_uint16, c_uint8]
+        _lib.pager_hline_alpha.restype = None
+        _lib.pager_fill_circle_alpha.argtypes = [c_int, c_int, c_int, c_uint16, c_uint8]
+        _lib.pager_fill_circle_alpha.restype = None
+        _lib.pager_fill_polygon.argtypes = [POINTER(PagerPoint), c_int, c_uint16]
+        _lib.pager_fill_polygon.restype = None
+        _lib.pager_fill_triangle.argtypes = [c_int, c_int, c_int, c_int, c_int, c_int, c_uint16]
+        _lib.pager_fill_triangle.restype = None
+        _lib.pager_draw_polyline.argtypes = [POINTER(PagerPoint), c_int, c_int, c_uint16]
+        _lib.pager_draw_polyline.restype = None
+        _lib.pager_set_pixels.argtypes = [POINTER(PagerPoint), POINTER(c_uint16), c_int]
+        _lib.pager_set_pixels.restype = None
+        _lib.pager_fill_rects.argtypes = [POINTER(PagerRect), c_int]
+        _lib.pager_fill_rects.restype = None
+        _lib.pager_draw_lines.argtypes = [POINTER(PagerLine), c_int]
+        _lib.pager_draw_lines.restype = None
+        _lib.pager_draw_circles.argtypes = [POINTER(PagerCircle), c_int, c_int]
+        _lib.pager_draw_circles.restype = None
 
         # Text (built-in font)
         _lib.pager_draw_char.argtypes = [c_int, c_int, c_char, c_uint16, c_int]
@@ -227,6 +420,10 @@ class Pager:
         _lib.pager_random.restype = c_int
         _lib.pager_seed_random.argtypes = [c_uint32]
         _lib.pager_seed_random.restype = None
+        _lib.pager_set_kernels.argtypes = [c_char_p]
+        _lib.pager_set_kernels.restype = c_int
+        _lib.pager_get_kernels.argtypes = []
+        _lib.pager_get_kernels.restype = c_char_p
 
         # Input
         _lib.pager_wait_button.argtypes = []
@@ -275,13 +472,36 @@ class Pager:
         _lib.pager_draw_image_scaled_rotated.restype = None
         _lib.pager_draw_image_file_scaled_rotated.argtypes = [c_int, c_int, c_int, c_int, c_char_p, c_int]
         _lib.pager_draw_image_file_scaled_rotated.restype = c_int
+        _lib.pager_create_mask.argtypes = [c_int, c_int, c_char_p]
+        _lib.pager_create_mask.restype = c_void_p
+        _lib.pager_load_mask.argtypes = [c_char_p]
+        _lib.pager_load_mask.restype = c_void_p
+        _lib.pager_free_mask.argtypes = [c_void_p]
+        _lib.pager_free_mask.restype = None
+        _lib.pager_draw_mask.argtypes = [c_int, c_int, c_void_p, c_uint16, c_int]
+        _lib.pager_draw_mask.restype = None
         _lib.pager_screenshot.argtypes = [c_char_p, c_int]
         _lib.pager_screenshot.restype = c_int
 
     # Initialization
-    def init(self):
-        """Initialize pager hardware. Call before any other functions."""
-        result = _lib.pager_init()
+    def init(self, calibrate_frames=None, display=None, device_root=None):
+        """Initialize pager hardware. Call before any other functions.
+
+        Args:
+            calibrate_frames: Optional number of full-frame writes to time at
+                              startup (see calibrate()). Default: environment.
+            display: Optional display backend: "fb", "memory" (headless) or
+                     "file:<path>" (raw RGB565 frames). Default: $PAGER_DISPLAY or "fb".
+            device_root: Optional prefix for all /dev and /sys paths, e.g. a
+                         fake device tree. Default: $PAGER_ROOT.
+        """
+        if calibrate_frames is None and display is None and device_root is None:
+            result = _lib.pager_init()
+        else:
+            opts = PagerOptions(calibrate_frames=calibrate_frames or 0,
+                                display=display.encode() if display else None,
+                                device_root=device_root.encode() if device_root else None)
+            result = _lib.pager_init_ex(byref(opts))
         if result == 0:
             self._initialized = True
         return result
@@ -292,11 +512,47 @@ class Pager:
             _lib.pager_cleanup()
             self._initialized = False
 
+    @property
+    def backend(self):
+        """Display path chosen at init: 'fb-pan', 'fb-mmap', 'fb-write',
+        'memory', 'file' or 'none'."""
+        return _lib.pager_get_backend().decode()
+
     # Rotation
     def set_rotation(self, rotation):
         """Set display rotation: 0, 90, 180, or 270."""
         _lib.pager_set_rotation(rotation)
 
+    # Clipping
+    def push_clip(self, x, y, w, h):
+        """Limit drawing to a rectangle (nested in the current clip).
+        Returns True on success, False if the clip stack is full."""
+        return _lib.pager_push_clip(x, y, w, h) == 0
+
+    def pop_clip(self):
+        """Restore the clip from before the last push_clip()."""
+        _lib.pager_pop_clip()
+
+    def reset_clip(self):
+        """Remove all clips."""
+        _lib.pager_reset_clip()
+
+    def get_clip(self):
+        """Current clip rectangle as (x, y, w, h)."""
+        x, y, w, h = c_int(), c_int(), c_int(), c_int()
+        _lib.pager_get_clip(byref(x), byref(y), byref(w), byref(h))
+        return (x.value, y.value, w.value, h.value)
+
+    def set_render_mode(self, mode):
+        """RENDER_LOGICAL draws rotated screens with the fast unrotated paths
+        and rotates once per flip. Returns True on success."""
+        return _lib.pager_set_render_mode(mode) == 0
+
+    @property
+    def render_mode(self):
+        """Current render mode (RENDER_DIRECT or RENDER_LOGICAL)."""
+        return _lib.pager_get_render_mode()
+
     @property
     def width(self):
         """Get current logical screen width."""
@@ -309,8 +565,14 @@ class Pager:
 
     # Frame management
     def flip(self):
-        """Display the current frame. Call once per frame."""
-        _lib.pager_flip()
+        """Display the current frame. Call once per frame.
+        Returns True if a frame was presented, False if nothing had changed."""
+        return bool(_lib.pager_flip())
+
+    @property
+    def generation(self):
+        """Drawing generation counter (changes whenever anything is drawn)."""
+        return _lib.pager_get_generation()
 
     def clear(self, color=0):
         """Clear screen to color (default black)."""
@@ -328,6 +590,110 @@ class Pager:
         """Frame rate limiter. Call at end of game loop."""
         return _lib.pager_frame_sync()
 
+    def set_frame_policy(self, policy):
+        """Late-frame policy: FRAME_SKIP (stay on the frame grid) or FRAME_CATCHUP."""
+        _lib.pager_set_frame_policy(policy)
+
+    def reset_frame_sync(self):
+        """Restart the frame schedule (e.g. after a pause)."""
+        _lib.pager_reset_frame_sync()
+
+    def frame_info(self):
+        """Get the frame pacing report as a dict (frame_us, late_us, frames,
+        frames_late, frames_skipped)."""
+        info = PagerFrameInfo()
+        _lib.pager_get_frame_info(byref(info))
+        return {name: getattr(info, name) for name, _ in PagerFrameInfo._fields_}
+
+    # Row differencing / flip statistics
+    def set_row_diff(self, enable=True):
+        """Skip sending damaged rows whose contents did not change.
+        Useful for apps that clear and redraw the whole screen every frame."""
+        _lib.pager_set_row_diff(1 if enable else 0)
+
+    @property
+    def row_diff(self):
+        """True if row differencing is enabled."""
+        return bool(_lib.pager_get_row_diff())
+
+    def flip_stats(self):
+        """Get flip counters as a dict (frames_presented, rows_written,
+        rows_skipped, bytes_written, bytes_saved, frames_elided)."""
+        stats = PagerFlipStats()
+        _lib.pager_get_flip_stats(byref(stats))
+        return {name: getattr(stats, name) for name, _ in PagerFlipStats._fields_}
+
+    def reset_flip_stats(self):
+        """Zero the flip counters."""
+        _lib.pager_reset_flip_stats()
+
+    # Asynchronous flip
+    def set_async_flip(self, enable=True):
+        """Present frames from a background thread so flip() returns immediately.
+        Returns 0 on success, -1 if unsupported by the display backend."""
+        return _lib.pager_set_async_flip(1 if enable else 0)
+
+    @property
+    def async_flip(self):
+        """True if asynchronous flipping is enabled."""
+        return bool(_lib.pager_get_async_flip())
+
+    def flip_fence(self):
+        """Fence for the most recently flipped frame (pass to flip_wait)."""
+        return _lib.pager_flip_fence()
+
+    def flip_wait(self, fence=None, timeout_ms=-1):
+        """Wait until a flipped frame is on the display (default: the latest).
+        timeout_ms: 0 = poll, -1 = forever. Returns True once presented."""
+        if fence is None:
+            fence = _lib.pager_flip_fence()
+        return _lib.pager_flip_wait(fence, timeout_ms) == 0
+
+    # Target frame rate / calibration
+    def set_target_fps(self, fps):
+        """Set the frame_sync() rate. 0 = use the calibrated rate."""
+        _lib.pager_set_target_fps(fps)
+
+    @property
+    def target_fps(self):
+        """Frame rate frame_sync() is pacing to."""
+        return _lib.pager_get_target_fps()
+
+    def calibrate(self, frames=10):
+        """Time full-frame writes to the display. Returns a dict (frame_us,
+        row_call_us, bytes_per_sec, max_fps) or None if not initialized."""
+        cal = PagerCalibration()
+        if _lib.pager_calibrate(frames, byref(cal)) != 0:
+            return None
+        return {name: getattr(cal, name) for name, _ in PagerCalibration._fields_}
+
+    def calibration(self):
+        """Get the last calibration result as a dict, or None."""
+        cal = PagerCalibration()
+        if _lib.pager_get_calibration(byref(cal)) != 0:
+            return None
+        return {name: getattr(cal, name) for name, _ in PagerCalibration._fields_}
+
+    # Damage tracking
+    def damage_rect(self, x, y, w, h):
+        """Force a rectangle to be sent on the next flip."""
+        _lib.pager_damage_rect(x, y, w, h)
+
+    def damage_all(self):
+        """Force the whole frame to be sent on the next flip."""
+        _lib.pager_damage_all()
+
+    def clear_damage(self):
+        """Discard pending damage (next flip sends nothing new)."""
+        _lib.pager_clear_damage()
+
+    def get_damage(self):
+        """Get the damaged bounding box. Returns (x, y, w, h) or None if clean."""
+        x, y, w, h = c_int(), c_int(), c_int(), c_int()
+        if _lib.pager_get_damage(byref(x), byref(y), byref(w), byref(h)):
+            return (x.value, y.value, w.value, h.value)
+        return None
+
     # Color helpers
     @staticmethod
     def rgb(r, g, b):
@@ -375,6 +741,98 @@ class Pager:
         """Draw a circle outline."""
         _lib.pager_draw_circle(cx, cy, r, color)
 
+    def line_aa(self, x0, y0, x1, y1, color):
+        """Draw an anti-aliased line."""
+        _lib.pager_draw_line_aa(x0, y0, x1, y1, color)
+
+    def circle_aa(self, cx, cy, r, color):
+        """Draw an anti-aliased circle outline."""
+        _lib.pager_draw_circle_aa(cx, cy, r, color)
+
+    def fill_ellipse(self, cx, cy, rx, ry, color):
+        """Draw a filled ellipse."""
+        _lib.pager_fill_ellipse(cx, cy, rx, ry, color)
+
+    def ellipse(self, cx, cy, rx, ry, color):
+        """Draw an ellipse outline."""
+        _lib.pager_draw_ellipse(cx, cy, rx, ry, color)
+
+    def fill_round_rect(self, x, y, w, h, r, color):
+        """Draw a filled rectangle with rounded corners."""
+        _lib.pager_fill_round_rect(x, y, w, h, r, color)
+
+    def round_rect(self, x, y, w, h, r, color):
+        """Draw a rounded rectangle outline."""
+        _lib.pager_draw_round_rect(x, y, w, h, r, color)
+
+    def fill_gradient(self, x, y, w, h, color0, color1, horizontal=False):
+        """Fill a rectangle with a linear gradient (top to bottom, or left to right)."""
+        if horizontal:
+            _lib.pager_fill_hgradient(x, y, w, h, color0, color1)
+        else:
+            _lib.pager_fill_vgradient(x, y, w, h, color0, color1)
+
+    def scroll_region(self, x, y, w, h, dx, dy, fill=0):
+        """Move a rectangle's contents by (dx, dy), filling the uncovered strip."""
+        _lib.pager_scroll_region(x, y, w, h, dx, dy, fill)
+
+    def fill_rect_alpha(self, x, y, w, h, color, alpha):
+        """Blend a filled rectangle over the screen (alpha 0-255)."""
+        _lib.pager_fill_rect_alpha(x, y, w, h, color, alpha)
+
+    def hline_alpha(self, x, y, w, color, alpha):
+        """Blend a horizontal line over the screen (alpha 0-255)."""
+        _lib.pager_hline_alpha(x, y, w, color, alpha)
+
+    def fill_circle_alpha(self, cx, cy, r, color, alpha):
+        """Blend a filled circle over the screen (alpha 0-255)."""
+        _lib.pager_fill_circle_alpha(cx, cy, r, color, alpha)
+
+    def fill_polygon(self, points, color):
+        """Draw a filled polygon from a list of (x, y) points."""
+        n = len(points)
+        arr = (PagerPoint * n)(*[PagerPoint(x, y) for x, y in points])
+        _lib.pager_fill_polygon(arr, n, color)
+
+    def fill_triangle(self, x0, y0, x1, y1, x2, y2, color):
+        """Draw a filled triangle."""
+        _lib.pager_fill_triangle(x0, y0, x1, y1, x2, y2, color)
+
+    def polyline(self, points, color, width=1):
+        """Draw connected line segments through a list of (x, y) points."""
+        n = len(points)
+        arr = (PagerPoint * n)(*[PagerPoint(x, y) for x, y in points])
+        _lib.pager_draw_polyline(arr, n, width, color)
+
+    # Batched drawing: one library call for a whole list of shapes
+    def set_pixels(self, points, colors):
+        """Set pixels from a list of (x, y) points. colors is a list with
+        one color per point, or a single color for all of them."""
+        n = len(points)
+        if isinstance(colors, int):
+            colors = [colors] * n
+        pts = (PagerPoint * n)(*[PagerPoint(x, y) for x, y in points])
+        cols = (c_uint16 * n)(*colors[:n])
+        _lib.pager_set_pixels(pts, cols, min(n, len(colors)))
+
+    def fill_rects(self, rects):
+        """Draw filled rectangles from a list of (x, y, w, h, color)."""
+        n = len(rects)
+        arr = (PagerRect * n)(*[PagerRect(*r) for r in rects])
+        _lib.pager_fill_rects(arr, n)
+
+    def lines(self, lines):
+        """Draw lines from a list of (x0, y0, x1, y1, color)."""
+        n = len(lines)
+        arr = (PagerLine * n)(*[PagerLine(*l) for l in lines])
+        _lib.pager_draw_lines(arr, n)
+
+    def circles(self, circles, filled=False):
+        """Draw circles from a list of (cx, cy, r, color)."""
+        n = len(circles)
+        arr = (PagerCircle * n)(*[PagerCircle(*c) for c in circles])
+        _lib.pager_draw_circles(arr, n, 1 if filled else 0)
+
     # Text (built-in bitmap font)
     def draw_char(self, x, y, char, color, size=1):
         """Draw a single character. Returns width."""
@@ -484,6 +942,16 @@ class Pager:
         """Seed the random number generator."""
         _lib.pager_seed_random(seed)
 
+    def set_kernels(self, name=None):
+        """Select pixel kernels: "c", "dsp" or None for the best available.
+        Returns True on success."""
+        return _lib.pager_set_kernels(name.encode() if name else None) == 0
+
+    @property
+    def kernels(self):
+        """Name of the pixel kernels in use ("c" or "dsp")."""
+        return _lib.pager_get_kernels().decode()
+
     # Input
     def wait_button(self):
         """Wait for any button press (blocking)."""
@@ -643,6 +1111,33 @@ class Pager:
         """Load and draw image from file, scaled and rotated. Returns 0 on success."""
         return _lib.pager_draw_image_file_scaled_rotated(x, y, w, h, filepath.encode(), rotation)
 
+    # Masks (1 bit per pixel, for icons)
+    def create_mask(self, width, height, bits=None):
+        """Create a mask from bytes: rows of (width + 7) // 8 bytes, MSB
+        first. Returns opaque handle for draw_mask(); call free_mask()."""
+        if bits is not None:
+            bits = bytes(bits)
+            if len(bits) < ((width + 7) // 8) * height:
+                raise ValueError("mask data too short")
+        handle = _lib.pager_create_mask(width, height, bits)
+        return handle if handle else None
+
+    def load_mask(self, filepath):
+        """Load image as a mask (set where at least half opaque/bright).
+        Call free_mask() when done. Returns None on error."""
+        handle = _lib.pager_load_mask(filepath.encode())
+        return handle if handle else None
+
+    def free_mask(self, handle):
+        """Free a mask."""
+        if handle:
+            _lib.pager_free_mask(handle)
+
+    def draw_mask(self, x, y, handle, fg, bg=None):
+        """Draw a mask: set bits in fg, clear bits in bg (None = transparent)."""
+        if handle:
+            _lib.pager_draw_mask(x, y, handle, fg, PAGER_TRANSPARENT if bg is None else bg)
+
     def screenshot(self, filepath, rotation=270):
         """Save hardware display to PNG or BMP. Reads /dev/fb0 directly.
         rotation: 0=portrait (222x480), 270=landscape (480x222, default).
@@ -0,0 +1,209 @@
+/*
+ * bench.c - pagerctl pixel kernel benchmarks
+ *
+ * Times the drawing paths that run on the pixel kernels (fills, image
+ * blits, alpha blending, format conversion) once per kernel table, so
+ * the portable C kernels can be compared with the MIPS DSP ASE ones.
+ * The span primitives are also timed at 90 and 270 degrees, which should
+ * come out close to the 0 degree numbers.
+ *
+ * Build:
+ *   make            (builds examples/bench next to the demo)
+ *
+ * Run on Pager (the display defaults to "memory", so no screen is needed):
+ *   ./bench [iterations]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "pagerctl.h"
+
+#define IMG_SIZE   128
+#define PPM_SIZE   256
+#define PPM_PATH   "/tmp/pagerctl_bench.ppm"
+#define SHOT_PATH  "/tmp/pagerctl_bench.bmp"
+
+static pager_image_t opaque_img;
+static pager_image_t alpha_img;
+static int frame;
+
+static double now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+/* Fill both test images with a gradient; the alpha one ramps 0..255 */
+static int make_images(void) {
+    int n = IMG_SIZE * IMG_SIZE;
+    opaque_img.width = alpha_img.width = IMG_SIZE;
+    opaque_img.height = alpha_img.height = IMG_SIZE;
+    opaque_img.pixels = malloc(n * sizeof(uint16_t));
+    alpha_img.pixels = opaque_img.pixels;
+    alpha_img.alpha = malloc(n);
+    if (!opaque_img.pixels || !alpha_img.alpha) return -1;
+
+    for (int y = 0; y < IMG_SIZE; y++) {
+        for (int x = 0; x < IMG_SIZE; x++) {
+            opaque_img.pixels[y * IMG_SIZE + x] = RGB565(x * 2, y * 2, 255 - x);
+            alpha_img.alpha[y * IMG_SIZE + x] = (uint8_t)((x + y) & 0xFF);
+        }
+    }
+    return 0;
+}
+
+/* Write a PPM for the RGB888 -> RGB565 conversion in pager_load_image() */
+static int make_ppm(void) {
+    FILE *f = fopen(PPM_PATH, "wb");
+    if (!f) return -1;
+    fprintf(f, "P6\n%d %d\n255\n", PPM_SIZE, PPM_SIZE);
+    for (int i = 0; i < PPM_SIZE * PPM_SIZE; i++) {
+        unsigned char px[3] = { i & 0xFF, (i >> 8) & 0xFF, (i * 7) & 0xFF };
+        fwrite(px, 1, 3, f);
+    }
+    fclose(f);
+    return 0;
+}
+
+static void bench_clear(void) {
+    pager_clear((frame++ & 1) ? COLOR_BLUE : COLOR_RED);
+}
+
+static void bench_fill_rect(void) {
+    pager_fill_rect(11, 17, 200, 150, (frame++ & 1) ? COLOR_CYAN : COLOR_ORANGE);
+}
+
+static void bench_hlines(void) {
+    for (int y = 0; y < 100; y++) {
+        pager_hline(11, y, 200, (frame & 1) ? COLOR_CYAN : COLOR_ORANGE);
+    }
+    frame++;
+}
+
+static void bench_vlines(void) {
+    for (int x = 0; x < 100; x++) {
+        pager_vline(x, 11, 200, (frame & 1) ? COLOR_CYAN : COLOR_ORANGE);
+    }
+    frame++;
+}
+
+static void bench_pixels(void) {
+    for (int i = 0; i < 1000; i++) {
+        pager_set_pixel(i % 200, i / 200, (frame & 1) ? COLOR_CYAN : COLOR_ORANGE);
+    }
+    frame++;
+}
+
+static void bench_blit(void) {
+    pager_draw_image(frame++ & 7, 40, &opaque_img);
+}
+
+static void bench_blend(void) {
+    pager_draw_image(frame++ & 7, 40, &alpha_img);
+}
+
+static void bench_load(void) {
+    pager_free_image(pager_load_image(PPM_PATH));
+}
+
+static void bench_screenshot(void) {
+    pager_screenshot(SHOT_PATH, 0);
+}
+
+typedef struct {
+    const char *name;
+    void (*run)(void);
+    int divisor;  /* Run 1/divisor as many iterations (slow cases) */
+    pager_rotation_t rotation;
+} bench_case_t;
+
+static const bench_case_t cases[] = {
+    { "clear (full frame)",        bench_clear,      1,  ROTATION_0 },
+    { "fill_rect 200x150",         bench_fill_rect,  1,  ROTATION_0 },
+    { "fill_rect 200x150 @90",     bench_fill_rect,  1,  ROTATION_90 },
+    { "fill_rect 200x150 @270",    bench_fill_rect,  1,  ROTATION_270 },
+    { "hline 200 x100",            bench_hlines,     1,  ROTATION_0 },
+    { "hline 200 x100 @90",        bench_hlines,     1,  ROTATION_90 },
+    { "hline 200 x100 @270",       bench_hlines,     1,  ROTATION_270 },
+    { "vline 200 x100",            bench_vlines,     1,  ROTATION_0 },
+    { "vline 200 x100 @90",        bench_vlines,     1,  ROTATION_90 },
+    { "vline 200 x100 @270",       bench_vlines,     1,  ROTATION_270 },
+    { "set_pixel x1000",           bench_pixels,     1,  ROTATION_0 },
+    { "set_pixel x1000 @90",       bench_pixels,     1,  ROTATION_90 },
+    { "draw_image 128x128",        bench_blit,       1,  ROTATION_0 },
+    { "draw_image 128x128 @90",    bench_blit,       1,  ROTATION_90 },
+    { "draw_image 128x128 alpha",  bench_blend,      1,  ROTATION_0 },
+    { "draw_image alpha @90",      bench_blend,      1,  ROTATION_90 },
+    { "load_image 256x256 PPM",    bench_load,       10, ROTATION_0 },
+    { "screenshot BMP",            bench_screenshot, 20, ROTATION_0 },
+};
+
+#define NUM_CASES (int)(sizeof(cases) / sizeof(cases[0]))
+
+int main(int argc, char *argv[]) {
+    int iterations = argc > 1 ? atoi(argv[1]) : 500;
+    if (iterations <= 0) iterations = 500;
+
+    /* Headless unless told otherwise: only the CPU work is measured */
+    pager_options_t opts;
+    memset(&opts, 0, sizeof(opts));
+    opts.display = getenv("PAGER_DISPLAY") ? NULL : "memory";
+    if (pager_init_ex(&opts) != 0) {
+        fprintf(stderr, "pager_init failed\n");
+        return 1;
+    }
+    if (make_images() != 0 || make_ppm() != 0) {
+        fprintf(stderr, "Failed to set up test data\n");
+        pager_cleanup();
+        return 1;
+    }
+
+    const char *tables[] = { "c", "dsp" };
+    double results[2][NUM_CASES];
+    int available[2] = { 0, 0 };
+
+    printf("pagerctl bench: display %s, %d iterations\n\n", pager_get_backend(), iterations);
+
+    for (int t = 0; t < 2; t++) {
+        if (pager_set_kernels(tables[t]) != 0) continue;
+        available[t] = 1;
+
+        for (int c = 0; c < NUM_CASES; c++) {
+            int n = iterations / cases[c].divisor;
+            if (n < 1) n = 1;
+
+            pager_set_rotation(cases[c].rotation);
+
+            cases[c].run();  /* Warm up caches */
+            double start = now_us();
+            for (int i = 0; i < n; i++) {
+                cases[c].run();
+            }
+            results[t][c] = (now_us() - start) / n;
+
+            /* Keep damage from piling up */
+            pager_clear_damage();
+        }
+    }
+
+    printf("%-26s %12s %12s %8s\n", "case", "c (us)", "dsp (us)", "speedup");
+    for (int c = 0; c < NUM_CASES; c++) {
+        printf("%-26s %12.1f ", cases[c].name, results[0][c]);
+        if (available[1]) {
+            printf("%12.1f %7.2fx\n", results[1][c], results[0][c] / results[1][c]);
+        } else {
+            printf("%12s %8s\n", "n/a", "");
+        }
+    }
+
+    pager_set_kernels(NULL);
+    pager_set_rotation(ROTATION_0);
+    free(opaque_img.pixels);
+    free(alpha_img.alpha);
+    remove(PPM_PATH);
+    remove(SHOT_PATH);
+    pager_cleanup();
+    return 0;
+}
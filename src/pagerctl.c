@@ -13,6 +13,9 @@
 #include <errno.h>
 #include <signal.h>
 #include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <dirent.h>
 #include <sys/time.h>
 #include <sys/wait.h>
 #include <linux/fb.h>
@@ -35,8 +38,27 @@
 
 /* Framebuffer state */
 static int fb_fd = -1;
-static uint16_t *framebuffer = NULL;
-static struct timeval start_time;
+static uint16_t *framebuffer = NULL;  /* Back buffer (framebuffer order) */
+static int64_t start_ns = 0;          /* CLOCK_MONOTONIC at pager_init() */
+
+/* How pager_flip() gets the back buffer onto the panel */
+typedef enum {
+    FB_MODE_WRITE = 0,   /* Private back buffer, pwrite() to /dev/fb0 */
+    FB_MODE_MMAP,        /* Private back buffer, memcpy() into the mapped fb */
+    FB_MODE_PAN,         /* Draw into the hidden page, FBIOPAN_DISPLAY to show it */
+    FB_MODE_MEMORY,      /* Headless: fb_map is a heap copy of the "panel" */
+    FB_MODE_FILE,        /* Headless: raw RGB565 frames written to a file or pipe */
+} fb_mode_t;
+
+#define FB_FRAME_BYTES (PAGER_STRIDE * PAGER_FB_HEIGHT)
+
+static fb_mode_t fb_mode = FB_MODE_WRITE;
+static uint8_t *fb_map = NULL;        /* mmap of /dev/fb0 (MMAP/PAN), heap frame (MEMORY) */
+static size_t fb_map_size = 0;
+static int fb_front_page = 0;         /* Page currently scanned out (PAN mode) */
+static struct fb_var_screeninfo fb_vinfo;
+static int fb_stream = 0;             /* FILE mode on a pipe/FIFO: whole frames in sequence */
+static int fb_stream_closed = 0;      /* The stream failed (e.g. reader gone); frames are dropped */
 
 /* Input state */
 static int input_fd = -1;
@@ -58,8 +80,82 @@ static pager_rotation_t current_rotation = ROTATION_0;
 static int logical_width = PAGER_FB_WIDTH;
 static int logical_height = PAGER_FB_HEIGHT;
 
-/* Hardware paths */
-#define VIBRATOR_PATH "/sys/class/gpio/vibrator/value"
+/* Clip rectangle in logical coordinates (exclusive max). Every primitive
+ * intersects its extents with it. pager_push_clip() saves the old one. */
+#define CLIP_STACK_DEPTH 16
+static int clip_x1 = 0;
+static int clip_y1 = 0;
+static int clip_x2 = PAGER_FB_WIDTH;
+static int clip_y2 = PAGER_FB_HEIGHT;
+static int clip_stack[CLIP_STACK_DEPTH][4];
+static int clip_depth = 0;
+
+/* Logical render mode: with a rotation active, primitives draw into
+ * logical_buf (logical orientation, logical_width pixels per row) and
+ * pager_flip() rotates the damaged part into the framebuffer once */
+static pager_render_mode_t render_mode = PAGER_RENDER_DIRECT;
+static uint16_t *logical_buf = NULL;
+
+/* Damage tracking (framebuffer coordinates, exclusive max).
+ * damage_rows marks which scanlines pager_flip() must send to the display;
+ * the bounding box is kept alongside for pager_get_damage(). */
+static uint8_t damage_rows[PAGER_FB_HEIGHT];
+/* Rows drawn but then dropped by pager_clear_damage(). They are not
+ * sent, but with more than one buffer (PAN mode, async flip) the other
+ * buffers must still catch up on them or the buffers drift apart. */
+static uint8_t discarded_rows[PAGER_FB_HEIGHT];
+static int damage_x1 = PAGER_FB_WIDTH;
+static int damage_y1 = PAGER_FB_HEIGHT;
+static int damage_x2 = 0;
+static int damage_y2 = 0;
+
+/* Generation counters: every drawing call bumps draw_generation, and
+ * pager_flip() skips the device entirely while it equals presented_generation */
+static uint32_t draw_generation = 0;
+static uint32_t presented_generation = 0;
+
+/* Clean rows shorter than this between two damaged bands are sent anyway,
+ * since one larger write is cheaper than an extra syscall over SPI.
+ * pager_calibrate() replaces the default with a measured value (min 1). */
+#define DAMAGE_MERGE_ROWS 4
+static int damage_merge_rows = DAMAGE_MERGE_ROWS;
+
+/* Row differencing: per-scanline hash of the last frame handed to the
+ * display. Damaged rows whose hash still matches are not sent again. */
+static int row_diff = 0;
+static uint32_t row_hash_a[PAGER_FB_HEIGHT];
+static uint32_t row_hash_b[PAGER_FB_HEIGHT];
+static uint8_t row_hash_valid[PAGER_FB_HEIGHT];
+
+/* Flip statistics (guarded by flip_mutex) */
+static pager_flip_stats_t flip_stats;
+
+/* 32-bit view of pixel pairs for word-at-a-time loops */
+typedef uint32_t __attribute__((__may_alias__)) u32_alias_t;
+
+/* Four pixels per store on 64-bit hosts */
+#if UINTPTR_MAX > 0xFFFFFFFFu
+#define SPAN_FILL_64 1
+typedef uint64_t __attribute__((__may_alias__)) u64_alias_t;
+#endif
+
+/* Hardware paths (relative to the device root, see root_path()) */
+#define FB_DEVICE_PATH      "/dev/fb0"
+#define VIBRATOR_PATH       "/sys/class/gpio/vibrator/value"
+#define BUZZER_FREQ_PATH    "/sys/class/leds/buzzer/frequency"
+#define BUZZER_PATH         "/sys/class/leds/buzzer/brightness"
+#define BACKLIGHT_BASE_PATH "/sys/class/backlight"
+
+/* Prefix for every device path, e.g. a fake /dev + /sys tree on a host.
+ * Empty means the real root. Set by pager_init_ex() or $PAGER_ROOT. */
+static char device_root[256];
+static int device_root_loaded = 0;
+
+/* Cached backlight path (found on first use, forgotten when the device
+ * root changes) */
+static char backlight_path[600] = {0};
+static int backlight_path_checked = 0;
+static int max_brightness_cached = -1;
 
 /* 5x7 bitmap font (ASCII 32-127) */
 static const uint8_t font_5x7[][5] = {
@@ -177,26 +273,394 @@ static void signal_handler(int sig) {
 /* Forward declaration for TTF cleanup (defined at end of file) */
 void pager_ttf_cleanup(void);
 
+/* Forward declarations for logical render mode (defined after damage tracking) */
+static int logical_attach(void);
+static void logical_detach(int flush);
+
+/* Forward declaration for the span writer tables (defined with the spans) */
+static void select_spans(void);
+
+/* Current CLOCK_MONOTONIC time in nanoseconds (immune to NTP steps) */
+static int64_t monotonic_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+/* Sleep until an absolute CLOCK_MONOTONIC deadline */
+static void sleep_until_ns(int64_t deadline) {
+    struct timespec ts;
+    ts.tv_sec = (time_t)(deadline / 1000000000LL);
+    ts.tv_nsec = (long)(deadline % 1000000000LL);
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR) {
+        /* Restart with the same absolute deadline */
+    }
+}
+
+/* Fill n pixels with one color using the widest aligned stores available.
+ * The color is repeated in every halfword, so byte order does not matter. */
+static void fill_span16(uint16_t *dst, uint16_t color, int n) {
+    if (n <= 0) return;
+
+    /* Head: one pixel to reach a word boundary */
+    if ((uintptr_t)dst & 2) {
+        *dst++ = color;
+        n--;
+    }
+
+    uint32_t pair = ((uint32_t)color << 16) | color;
+#ifdef SPAN_FILL_64
+    if (n >= 2 && ((uintptr_t)dst & 4)) {
+        *(u32_alias_t *)dst = pair;
+        dst += 2;
+        n -= 2;
+    }
+    uint64_t quad = ((uint64_t)pair << 32) | pair;
+    u64_alias_t *q = (u64_alias_t *)dst;
+    for (; n >= 16; n -= 16, q += 4) {
+        q[0] = quad; q[1] = quad; q[2] = quad; q[3] = quad;
+    }
+    for (; n >= 4; n -= 4) *q++ = quad;
+    dst = (uint16_t *)q;
+#endif
+    u32_alias_t *w = (u32_alias_t *)dst;
+    for (; n >= 8; n -= 8, w += 4) {
+        w[0] = pair; w[1] = pair; w[2] = pair; w[3] = pair;
+    }
+    for (; n >= 2; n -= 2) *w++ = pair;
+    dst = (uint16_t *)w;
+
+    /* Tail */
+    if (n) *dst = color;
+}
+
 /*
- * Initialization
+ * Pixel kernels
+ *
+ * The inner loops of fills, blits, alpha blending and pixel format
+ * conversion go through a table so a CPU-specific version can be picked
+ * at pager_init(). The portable table is the reference.
  */
 
-int pager_init(void) {
+/* Pixel loops that have an optimized variant */
+typedef struct {
+    const char *name;
+    void (*fill)(uint16_t *dst, uint16_t color, int n);
+    void (*copy)(uint16_t *dst, const uint16_t *src, int n);
+    /* Blend src over dst with per-pixel alpha (0 = keep dst, 255 = src) */
+    void (*blend)(uint16_t *dst, const uint16_t *src, const uint8_t *alpha, int n);
+    /* Packed 8-bit RGB (bpp 3) or RGBA (bpp 4, alpha ignored) to RGB565 */
+    void (*rgb888_to_565)(uint16_t *dst, const uint8_t *src, int bpp, int n);
+    /* RGB565 to packed 8-bit RGB */
+    void (*rgb565_to_888)(uint8_t *dst, const uint16_t *src, int n);
+    /* Blend one colour over dst at a constant alpha in 32nds (1..31) */
+    void (*tint)(uint16_t *dst, uint16_t color, uint32_t alpha, int n);
+} pixel_kernels_t;
+
+/* Convert RGB888 to RGB565 */
+static inline uint16_t rgb888_to_rgb565(uint8_t r, uint8_t g, uint8_t b) {
+    return ((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3);
+}
+
+/* Alpha-blend foreground RGB565 over background RGB565.
+ * Uses >> 8 approximation instead of / 255 for speed on MIPS. */
+static inline uint16_t blend_rgb565(uint16_t fg, uint16_t bg, uint8_t alpha) {
+    uint8_t inv = 255 - alpha;
+
+    uint32_t fg_r = (fg >> 11) & 0x1F;
+    uint32_t fg_g = (fg >> 5)  & 0x3F;
+    uint32_t fg_b = fg & 0x1F;
+
+    uint32_t bg_r = (bg >> 11) & 0x1F;
+    uint32_t bg_g = (bg >> 5)  & 0x3F;
+    uint32_t bg_b = bg & 0x1F;
+
+    uint32_t r = (fg_r * alpha + bg_r * inv) >> 8;
+    uint32_t g = (fg_g * alpha + bg_g * inv) >> 8;
+    uint32_t b = (fg_b * alpha + bg_b * inv) >> 8;
+
+    return (uint16_t)((r << 11) | (g << 5) | b);
+}
+
+/* RGB565 spread out as 0000 0GGG GGG0 0000 RRRR R000 000B BBBB so one
+ * multiply scales all three channels; the gaps absorb the overflow. */
+static inline uint32_t rgb565_expand(uint16_t c) {
+    return (c | ((uint32_t)c << 16)) & 0x07E0F81F;
+}
+
+static inline uint16_t rgb565_pack(uint32_t x) {
+    x &= 0x07E0F81F;
+    return (uint16_t)(x | (x >> 16));
+}
+
+/* Blend an expanded foreground over *dst with a 5-bit alpha (0..32) */
+static inline void blend_expanded(uint16_t *dst, uint32_t fg, uint32_t alpha) {
+    uint32_t bg = rgb565_expand(*dst);
+    *dst = rgb565_pack(bg + (((fg - bg) * alpha) >> 5));
+}
+
+/* 8-bit alpha (0..255) to the 5-bit alpha of the packed blends (0..32) */
+static inline uint32_t alpha5(uint32_t alpha) {
+    return (alpha * 33) >> 8;
+}
+
+static void copy_c(uint16_t *dst, const uint16_t *src, int n) {
+    if (n > 0) memcpy(dst, src, (size_t)n * sizeof(uint16_t));
+}
+
+static void blend_c(uint16_t *dst, const uint16_t *src, const uint8_t *alpha, int n) {
+    for (int i = 0; i < n; i++) {
+        uint8_t a = alpha[i];
+        if (a == 255) {
+            dst[i] = src[i];
+        } else if (a != 0) {
+            dst[i] = blend_rgb565(src[i], dst[i], a);
+        }
+    }
+}
+
+static void rgb888_to_565_c(uint16_t *dst, const uint8_t *src, int bpp, int n) {
+    for (int i = 0; i < n; i++, src += bpp) {
+        dst[i] = rgb888_to_rgb565(src[0], src[1], src[2]);
+    }
+}
+
+/* The foreground term is premultiplied once, leaving one multiply per
+ * pixel; both terms fit the gaps of the expanded layout unshifted. */
+static void tint_c(uint16_t *dst, uint16_t color, uint32_t alpha, int n) {
+    uint32_t fg = rgb565_expand(color) * alpha;
+    uint32_t inv = 32 - alpha;
+    for (int i = 0; i < n; i++) {
+        dst[i] = rgb565_pack((rgb565_expand(dst[i]) * inv + fg) >> 5);
+    }
+}
+
+static void rgb565_to_888_c(uint8_t *dst, const uint16_t *src, int n) {
+    for (int i = 0; i < n; i++, dst += 3) {
+        uint16_t px = src[i];
+        dst[0] = ((px >> 11) & 0x1F) << 3;  /* R */
+        dst[1] = ((px >> 5) & 0x3F) << 2;   /* G */
+        dst[2] = (px & 0x1F) << 3;          /* B */
+    }
+}
+
+static const pixel_kernels_t kernels_c = {
+    "c", fill_span16, copy_c, blend_c, rgb888_to_565_c, rgb565_to_888_c, tint_c,
+};
+
+/*
+ * MIPS DSP ASE (rev 1, as on the 24KEc). Two RGB565 pixels are handled
+ * as a pair of halfwords per register: each colour channel is unpacked
+ * into both lanes, blended with subq.ph / mulq_rs.ph / addq.ph and packed
+ * back with one word store. The instructions are enabled with .set dsp,
+ * so the library still builds for (and runs on) cores without the ASE;
+ * the table is only selected when /proc/cpuinfo lists "dsp".
+ *
+ * Fills, copies and conversions are bound by loads and stores, which the
+ * ASE does not widen, so those entries share the word-at-a-time code.
+ */
+#if defined(__mips__) && defined(__MIPSEL__) && !defined(__mips16) && !defined(__mips64)
+#define PAGER_HAVE_DSP 1
+
+/* Per lane: bg + round((fg - bg) * q / 32768), q in Q15 */
+static inline uint32_t dsp_lerp_ph(uint32_t fg, uint32_t bg, uint32_t q) {
+    uint32_t t;
+    __asm__ (".set push\n\t"
+             ".set dsp\n\t"
+             "subq.ph    %0, %1, %2\n\t"
+             "mulq_rs.ph %0, %0, %3\n\t"
+             "addq.ph    %0, %0, %2\n\t"
+             ".set pop"
+             : "=&r"(t)
+             : "r"(fg), "r"(bg), "r"(q));
+    return t;
+}
+
+static void blend_dsp(uint16_t *dst, const uint16_t *src, const uint8_t *alpha, int n) {
+    /* Head: one pixel to reach a word boundary in dst */
+    if (n > 0 && ((uintptr_t)dst & 2)) {
+        blend_c(dst++, src++, alpha++, 1);
+        n--;
+    }
+
+    u32_alias_t *d = (u32_alias_t *)dst;
+    for (; n >= 2; n -= 2, d++, src += 2, alpha += 2) {
+        uint32_t a0 = alpha[0], a1 = alpha[1];
+        if ((a0 | a1) == 0) continue;
+
+        uint32_t s = src[0] | ((uint32_t)src[1] << 16);
+        if ((a0 & a1) == 255) {
+            *d = s;
+            continue;
+        }
+
+        /* 0..255 to Q15 0..32767, so 255 reproduces src exactly */
+        uint32_t q = ((a0 << 7) | (a0 >> 1)) | (((a1 << 7) | (a1 >> 1)) << 16);
+        uint32_t b = *d;
+        uint32_t r = dsp_lerp_ph((s >> 11) & 0x001F001F, (b >> 11) & 0x001F001F, q);
+        uint32_t g = dsp_lerp_ph((s >> 5) & 0x003F003F, (b >> 5) & 0x003F003F, q);
+        uint32_t bl = dsp_lerp_ph(s & 0x001F001F, b & 0x001F001F, q);
+        *d = (r << 11) | (g << 5) | bl;
+    }
+
+    if (n) blend_c((uint16_t *)d, src, alpha, 1);
+}
+
+static void tint_dsp(uint16_t *dst, uint16_t color, uint32_t alpha, int n) {
+    if (n > 0 && ((uintptr_t)dst & 2)) {
+        tint_c(dst++, color, alpha, 1);
+        n--;
+    }
+
+    /* The colour's channels and the alpha are the same for every pair */
+    uint32_t q = (alpha << 10) | (alpha << 26);
+    uint32_t fr = ((color >> 11) & 0x1F) * 0x00010001;
+    uint32_t fg = ((color >> 5) & 0x3F) * 0x00010001;
+    uint32_t fb = (color & 0x1F) * 0x00010001;
+
+    u32_alias_t *d = (u32_alias_t *)dst;
+    for (; n >= 2; n -= 2, d++) {
+        uint32_t b = *d;
+        uint32_t r = dsp_lerp_ph(fr, (b >> 11) & 0x001F001F, q);
+        uint32_t g = dsp_lerp_ph(fg, (b >> 5) & 0x003F003F, q);
+        uint32_t bl = dsp_lerp_ph(fb, b & 0x001F001F, q);
+        *d = (r << 11) | (g << 5) | bl;
+    }
+
+    if (n) tint_c((uint16_t *)d, color, alpha, 1);
+}
+
+static const pixel_kernels_t kernels_dsp = {
+    "dsp", fill_span16, copy_c, blend_dsp, rgb888_to_565_c, rgb565_to_888_c, tint_dsp,
+};
+
+/* Does the kernel report the DSP ASE for this CPU? */
+static int cpu_has_dsp(void) {
+    FILE *f = fopen("/proc/cpuinfo", "r");
+    if (!f) return 0;
+
+    char line[256];
+    int found = 0;
+    while (!found && fgets(line, sizeof(line), f)) {
+        char *list = strchr(line, ':');
+        if (strncmp(line, "ASEs implemented", 16) != 0 || !list) continue;
+        for (char *tok = strtok(list + 1, " \t\n"); tok; tok = strtok(NULL, " \t\n")) {
+            if (strncmp(tok, "dsp", 3) == 0) found = 1;
+        }
+    }
+    fclose(f);
+    return found;
+}
+#endif
+
+static const pixel_kernels_t *kernels = &kernels_c;
+
+int pager_set_kernels(const char *name) {
+    if (!name || strcmp(name, "auto") == 0) {
+        kernels = &kernels_c;
+#ifdef PAGER_HAVE_DSP
+        if (cpu_has_dsp()) kernels = &kernels_dsp;
+#endif
+        return 0;
+    }
+    if (strcmp(name, "c") == 0) {
+        kernels = &kernels_c;
+        return 0;
+    }
+#ifdef PAGER_HAVE_DSP
+    if (strcmp(name, "dsp") == 0 && cpu_has_dsp()) {
+        kernels = &kernels_dsp;
+        return 0;
+    }
+#endif
+    return -1;
+}
+
+const char *pager_get_kernels(void) {
+    return kernels->name;
+}
+
+/* Use root as the device root prefix (NULL or "" = real root) */
+static void set_device_root(const char *root) {
+    snprintf(device_root, sizeof(device_root), "%s", root ? root : "");
+    size_t len = strlen(device_root);
+    while (len > 0 && device_root[len - 1] == '/') device_root[--len] = '\0';
+    device_root_loaded = 1;
+
+    /* The backlight found under the old root may not exist under the new one */
+    backlight_path_checked = 0;
+    backlight_path[0] = '\0';
+    max_brightness_cached = -1;
+}
+
+/* Resolve an absolute device path under the device root. Returns path
+ * itself when there is no root, otherwise the prefixed path in buf. */
+static const char *root_path(const char *path, char *buf, size_t len) {
+    if (!device_root_loaded) set_device_root(getenv("PAGER_ROOT"));
+    if (!device_root[0]) return path;
+    snprintf(buf, len, "%s%s", device_root, path);
+    return buf;
+}
+
+/* fopen()/open() on a path under the device root */
+static FILE *root_fopen(const char *path, const char *mode) {
+    char buf[512];
+    return fopen(root_path(path, buf, sizeof(buf)), mode);
+}
+
+static int root_open(const char *path, int flags) {
+    char buf[512];
+    return open(root_path(path, buf, sizeof(buf)), flags);
+}
+
+/* Get a pointer to one page of the mapped framebuffer */
+static uint16_t *fb_page(int page) {
+    return (uint16_t *)(fb_map + (size_t)page * FB_FRAME_BYTES);
+}
+
+/* Map /dev/fb0 and pick the cheapest way to present frames.
+ * Falls back to FB_MODE_WRITE if the layout is not what we expect
+ * or the driver does not support mmap. */
+static void fb_setup_mmap(const struct fb_fix_screeninfo *finfo) {
+    fb_mode = FB_MODE_WRITE;
+
+    if (fb_vinfo.xres != PAGER_FB_WIDTH || fb_vinfo.yres != PAGER_FB_HEIGHT ||
+        fb_vinfo.bits_per_pixel != PAGER_BPP || finfo->line_length != PAGER_STRIDE ||
+        finfo->smem_len < FB_FRAME_BYTES) {
+        return;
+    }
+
+    void *map = mmap(NULL, finfo->smem_len, PROT_READ | PROT_WRITE, MAP_SHARED, fb_fd, 0);
+    if (map == MAP_FAILED) return;
+
+    fb_map = (uint8_t *)map;
+    fb_map_size = finfo->smem_len;
+    fb_mode = FB_MODE_MMAP;
+
+    /* Page flipping needs a second page and a driver that can pan to it */
+    if (fb_vinfo.yres_virtual >= 2 * fb_vinfo.yres && fb_map_size >= 2 * FB_FRAME_BYTES) {
+        fb_vinfo.xoffset = 0;
+        fb_vinfo.yoffset = 0;
+        if (ioctl(fb_fd, FBIOPAN_DISPLAY, &fb_vinfo) == 0) {
+            fb_mode = FB_MODE_PAN;
+            fb_front_page = 0;
+            memset(discarded_rows, 0, sizeof(discarded_rows));
+        }
+    }
+}
+
+/* Open /dev/fb0 and pick its presentation mode. Returns -1 on failure. */
+static int fb_open_device(void) {
     struct fb_var_screeninfo vinfo;
     struct fb_fix_screeninfo finfo;
 
-    /* Set up signal handlers */
-    signal(SIGINT, signal_handler);
-    signal(SIGTERM, signal_handler);
-
-    /* Open framebuffer */
-    fb_fd = open("/dev/fb0", O_RDWR);
+    fb_fd = root_open(FB_DEVICE_PATH, O_RDWR);
     if (fb_fd < 0) {
         perror("Failed to open /dev/fb0");
         return -1;
     }
 
-    /* Get screen info (for verification) */
+    /* Get screen info (for verification and page flipping) */
     if (ioctl(fb_fd, FBIOGET_VSCREENINFO, &vinfo) < 0) {
         perror("FBIOGET_VSCREENINFO");
         close(fb_fd);
@@ -217,34 +681,177 @@ int pager_init(void) {
                 PAGER_FB_WIDTH, PAGER_FB_HEIGHT, vinfo.xres, vinfo.yres);
     }
 
-    /* Allocate framebuffer */
-    framebuffer = (uint16_t *)malloc(PAGER_FB_WIDTH * PAGER_FB_HEIGHT * sizeof(uint16_t));
-    if (!framebuffer) {
-        perror("Failed to allocate framebuffer");
-        close(fb_fd);
+    /* Map the framebuffer if the driver allows it */
+    fb_vinfo = vinfo;
+    fb_setup_mmap(&finfo);
+    return 0;
+}
+
+/* Headless display kept in memory. pager_screenshot() reads it back. */
+static int fb_open_memory(void) {
+    fb_map = (uint8_t *)calloc(1, FB_FRAME_BYTES);
+    if (!fb_map) {
+        perror("Failed to allocate display memory");
+        return -1;
+    }
+    fb_map_size = FB_FRAME_BYTES;
+    fb_mode = FB_MODE_MEMORY;
+    return 0;
+}
+
+/* Headless display backed by a file. A regular file always holds the
+ * latest frame (rows are written in place, like /dev/fb0) and is cut to
+ * exactly one frame, so nothing from an older, larger file lingers; a
+ * pipe or FIFO receives every presented frame in full, one after
+ * another. Opening a FIFO waits for its reader. When the reader goes
+ * away the stream stops with a message instead of raising SIGPIPE. */
+static int fb_open_file(const char *path) {
+    struct stat st;
+
+    if (stat(path, &st) == 0 && !S_ISREG(st.st_mode)) {
+        fb_fd = open(path, O_WRONLY);
+    } else {
+        fb_fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (fb_fd >= 0 && ftruncate(fb_fd, FB_FRAME_BYTES) < 0) {
+            close(fb_fd);
+            fb_fd = -1;
+        }
+    }
+    if (fb_fd < 0 || fstat(fb_fd, &st) < 0) {
+        fprintf(stderr, "Failed to open display file %s: %s\n", path, strerror(errno));
+        if (fb_fd >= 0) close(fb_fd);
         fb_fd = -1;
         return -1;
     }
+    fb_stream = !S_ISREG(st.st_mode);
+    fb_stream_closed = 0;
+    fb_mode = FB_MODE_FILE;
+    return 0;
+}
+
+/* Unmap and close the framebuffer device */
+static void fb_release(void) {
+    if (fb_map) {
+        if (fb_mode == FB_MODE_PAN && fb_front_page != 0) {
+            /* Leave page 0 on screen for whoever writes /dev/fb0 next */
+            fb_vinfo.yoffset = 0;
+            ioctl(fb_fd, FBIOPAN_DISPLAY, &fb_vinfo);
+        }
+        if (fb_mode == FB_MODE_MEMORY) {
+            free(fb_map);
+        } else {
+            munmap(fb_map, fb_map_size);
+        }
+        fb_map = NULL;
+        fb_map_size = 0;
+    }
+    fb_mode = FB_MODE_WRITE;
+    fb_stream = 0;
+    fb_stream_closed = 0;
+
+    if (fb_fd >= 0) {
+        close(fb_fd);
+        fb_fd = -1;
+    }
+}
+
+/*
+ * Initialization
+ */
+
+int pager_init(void) {
+    return pager_init_ex(NULL);
+}
+
+/* Fill in defaults for options not given, from the environment */
+static void load_init_options(const pager_options_t *opts, pager_options_t *out) {
+    memset(out, 0, sizeof(*out));
+    if (opts) {
+        *out = *opts;
+        return;
+    }
+
+    const char *env = getenv("PAGER_CALIBRATE");
+    if (env) out->calibrate_frames = atoi(env);
+}
+
+int pager_init_ex(const pager_options_t *opts) {
+    pager_options_t options;
+
+    load_init_options(opts, &options);
+
+    /* Device root from options wins over $PAGER_ROOT */
+    if (options.device_root) set_device_root(options.device_root);
+
+    /* Fastest pixel kernels this CPU supports */
+    pager_set_kernels(NULL);
+
+    /* The display can be redirected even when options are passed in code */
+    const char *display = options.display;
+    if (!display || !*display) display = getenv("PAGER_DISPLAY");
+    if (!display || !*display) display = "fb";
+
+    /* Set up signal handlers */
+    signal(SIGINT, signal_handler);
+    signal(SIGTERM, signal_handler);
+
+    /* Open the display */
+    int rc;
+    if (strcmp(display, "fb") == 0) {
+        rc = fb_open_device();
+    } else if (strcmp(display, "memory") == 0) {
+        rc = fb_open_memory();
+    } else if (strncmp(display, "file:", 5) == 0 && display[5]) {
+        rc = fb_open_file(display + 5);
+    } else {
+        fprintf(stderr, "Unknown display '%s' (use fb, memory or file:<path>)\n", display);
+        rc = -1;
+    }
+    if (rc < 0) return -1;
+
+    if (fb_mode == FB_MODE_PAN) {
+        /* Both pages start black; draw straight into the hidden one */
+        memset(fb_map, 0, 2 * FB_FRAME_BYTES);
+        framebuffer = fb_page(1);
+    } else {
+        /* Allocate framebuffer */
+        framebuffer = (uint16_t *)malloc(PAGER_FB_WIDTH * PAGER_FB_HEIGHT * sizeof(uint16_t));
+        if (!framebuffer) {
+            perror("Failed to allocate framebuffer");
+            fb_release();
+            return -1;
+        }
+        memset(framebuffer, 0, PAGER_FB_WIDTH * PAGER_FB_HEIGHT * sizeof(uint16_t));
+    }
 
-    /* Clear to black */
-    memset(framebuffer, 0, PAGER_FB_WIDTH * PAGER_FB_HEIGHT * sizeof(uint16_t));
+    /* First flip sends the whole (black) frame */
+    pager_damage_all();
 
     /* Open input device */
-    input_fd = open("/dev/input/event0", O_RDONLY | O_NONBLOCK);
+    input_fd = root_open("/dev/input/event0", O_RDONLY | O_NONBLOCK);
     if (input_fd < 0) {
         /* Try event1 as fallback */
-        input_fd = open("/dev/input/event1", O_RDONLY | O_NONBLOCK);
+        input_fd = root_open("/dev/input/event1", O_RDONLY | O_NONBLOCK);
     }
     if (input_fd < 0) {
         fprintf(stderr, "Warning: Could not open input device\n");
     }
 
     /* Initialize timing */
-    gettimeofday(&start_time, NULL);
+    start_ns = monotonic_ns();
 
     /* Seed random with time */
     pager_seed_random(pager_get_ticks());
 
+    /* Optionally measure what the panel can actually do */
+    if (options.calibrate_frames > 0) {
+        pager_calibration_t cal;
+        if (pager_calibrate(options.calibrate_frames, &cal) == 0) {
+            fprintf(stderr, "pagerctl: %u us/frame, %u bytes/sec, max %u FPS\n",
+                    cal.frame_us, cal.bytes_per_sec, cal.max_fps);
+        }
+    }
+
     return 0;
 }
 
@@ -252,7 +859,37 @@ int pager_init(void) {
  * Rotation support
  */
 
+/* Logical to framebuffer coordinates, one function per rotation so the
+ * rotation is decided once in pager_set_rotation() */
+static void to_fb_0(int lx, int ly, int *fx, int *fy) {
+    *fx = lx;
+    *fy = ly;
+}
+
+/* 90° CW: (lx,ly) -> (ly, 479-lx) for 480x222 logical */
+static void to_fb_90(int lx, int ly, int *fx, int *fy) {
+    *fx = ly;
+    *fy = PAGER_FB_HEIGHT - 1 - lx;
+}
+
+/* 180°: (lx,ly) -> (221-lx, 479-ly) */
+static void to_fb_180(int lx, int ly, int *fx, int *fy) {
+    *fx = PAGER_FB_WIDTH - 1 - lx;
+    *fy = PAGER_FB_HEIGHT - 1 - ly;
+}
+
+/* 270° CW (90° CCW): (lx,ly) -> (221-ly, lx) for 480x222 logical */
+static void to_fb_270(int lx, int ly, int *fx, int *fy) {
+    *fx = PAGER_FB_WIDTH - 1 - ly;
+    *fy = lx;
+}
+
+static void (*to_fb)(int lx, int ly, int *fx, int *fy) = to_fb_0;
+
 void pager_set_rotation(pager_rotation_t rotation) {
+    /* The logical buffer is laid out for the old orientation */
+    logical_detach(1);
+
     current_rotation = rotation;
     switch (rotation) {
         case ROTATION_90:
@@ -265,6 +902,18 @@ void pager_set_rotation(pager_rotation_t rotation) {
             logical_height = PAGER_FB_HEIGHT;  /* 480 */
             break;
     }
+    switch (rotation) {
+        case ROTATION_90:  to_fb = to_fb_90;  break;
+        case ROTATION_180: to_fb = to_fb_180; break;
+        case ROTATION_270: to_fb = to_fb_270; break;
+        default:           to_fb = to_fb_0;   break;
+    }
+
+    /* Clip rectangles do not survive a change of coordinate system */
+    pager_reset_clip();
+
+    if (render_mode == PAGER_RENDER_LOGICAL) logical_attach();
+    select_spans();
 }
 
 int pager_get_width(void) {
@@ -276,249 +925,2270 @@ int pager_get_height(void) {
 }
 
 /* Transform logical coordinates to framebuffer coordinates based on rotation */
-static void transform_coords(int lx, int ly, int *fx, int *fy) {
+static inline void transform_coords(int lx, int ly, int *fx, int *fy) {
+    to_fb(lx, ly, fx, fy);
+}
+
+/*
+ * Clipping
+ */
+
+int pager_push_clip(int x, int y, int w, int h) {
+    if (clip_depth >= CLIP_STACK_DEPTH) return -1;
+
+    int *saved = clip_stack[clip_depth++];
+    saved[0] = clip_x1;
+    saved[1] = clip_y1;
+    saved[2] = clip_x2;
+    saved[3] = clip_y2;
+
+    /* Nested clips can only shrink */
+    clip_x1 = MAX(clip_x1, x);
+    clip_y1 = MAX(clip_y1, y);
+    clip_x2 = MIN(clip_x2, x + w);
+    clip_y2 = MIN(clip_y2, y + h);
+    if (clip_x2 < clip_x1) clip_x2 = clip_x1;
+    if (clip_y2 < clip_y1) clip_y2 = clip_y1;
+    return 0;
+}
+
+void pager_pop_clip(void) {
+    if (clip_depth == 0) return;
+
+    int *saved = clip_stack[--clip_depth];
+    clip_x1 = saved[0];
+    clip_y1 = saved[1];
+    clip_x2 = saved[2];
+    clip_y2 = saved[3];
+}
+
+void pager_reset_clip(void) {
+    clip_depth = 0;
+    clip_x1 = 0;
+    clip_y1 = 0;
+    clip_x2 = logical_width;
+    clip_y2 = logical_height;
+}
+
+int pager_get_clip(int *x, int *y, int *w, int *h) {
+    if (x) *x = clip_x1;
+    if (y) *y = clip_y1;
+    if (w) *w = clip_x2 - clip_x1;
+    if (h) *h = clip_y2 - clip_y1;
+    return clip_x1 < clip_x2 && clip_y1 < clip_y2;
+}
+
+/* Intersect a logical rectangle (exclusive max) with the clip.
+ * Returns 0 if nothing is left to draw. */
+static inline int clip_rect(int *x1, int *y1, int *x2, int *y2) {
+    *x1 = MAX(*x1, clip_x1);
+    *y1 = MAX(*y1, clip_y1);
+    *x2 = MIN(*x2, clip_x2);
+    *y2 = MIN(*y2, clip_y2);
+    return *x1 < *x2 && *y1 < *y2;
+}
+
+/* True if the rectangle lies entirely inside the clip, so the caller can
+ * skip per-pixel checks */
+static inline int clip_contains(int x1, int y1, int x2, int y2) {
+    return x1 >= clip_x1 && y1 >= clip_y1 && x2 <= clip_x2 && y2 <= clip_y2;
+}
+
+/* True when logical rows are contiguous in the draw buffer (no rotation,
+ * or logical render mode), so primitives can use their row fast paths */
+static inline int draw_linear(void) {
+    return logical_buf || current_rotation == ROTATION_0;
+}
+
+/* Start of logical row y in the draw buffer (only valid if draw_linear()) */
+static inline uint16_t *draw_row(int y) {
+    return (logical_buf ? logical_buf : framebuffer) + y * logical_width;
+}
+
+/*
+ * Span writers
+ *
+ * Row and column writers for each layout of the draw buffer: plain rows
+ * (no rotation or logical render mode, 222 or 480 pixels wide) and the
+ * framebuffer seen at 90, 180 and 270 degrees. Every layout is affine,
+ * logical pixel (x, y) being at origin + x * xstep + y * ystep, so one
+ * macro generates all of them with the steps as constants: unit steps
+ * fold into the pixel kernels and nothing tests the rotation per pixel.
+ * select_spans() installs the table for the current layout.
+ */
+
+typedef struct {
+    int origin, xstep, ystep;
+    /* Logical pixels [x1, x2) of row y. The span must be non-empty and
+     * inside the clip; nothing is clipped or damaged here. */
+    void (*fill)(int x1, int x2, int y, uint16_t color);
+    void (*tint)(int x1, int x2, int y, uint16_t color, uint32_t alpha);
+    void (*copy)(int x1, int x2, int y, const uint16_t *src);
+    void (*blend)(int x1, int x2, int y, const uint16_t *src, const uint8_t *alpha);
+    /* Logical pixels [y1, y2) of column x, with the same rules */
+    void (*vfill)(int x, int y1, int y2, uint16_t color);
+} span_ops_t;
+
+/* The run helpers below are only ever called with a constant step, and
+ * must be inlined for it to fold */
+#define RUN_INLINE static inline __attribute__((__always_inline__))
+
+/* Fill n > 0 pixels starting at p, step apart. A run going backwards
+ * along a row (180 degrees) is the same contiguous run filled from its
+ * other end, so both directions reach the fill kernel; only the column
+ * walks of 90/270 degrees are strided. */
+RUN_INLINE void run_fill(uint16_t *p, int step, int n, uint16_t color) {
+    if (step == 1 || step == -1) {
+        kernels->fill(step == 1 ? p : p - (n - 1), color, n);
+        return;
+    }
+    for (; n >= 4; n -= 4) {
+        p[0] = color;
+        p[step] = color;
+        p[2 * step] = color;
+        p[3 * step] = color;
+        p += 4 * step;
+    }
+    for (; n > 0; n--) {
+        *p = color;
+        p += step;
+    }
+}
+
+/* run_fill() blending at alpha/32 (1..31) */
+RUN_INLINE void run_tint(uint16_t *p, int step, int n, uint16_t color, uint32_t alpha) {
+    if (step == 1 || step == -1) {
+        kernels->tint(step == 1 ? p : p - (n - 1), color, alpha, n);
+        return;
+    }
+    uint32_t fg = rgb565_expand(color);
+    for (; n > 0; n--) {
+        blend_expanded(p, fg, alpha);
+        p += step;
+    }
+}
+
+/* Copy n > 0 pixels from src to p, p moving step apart */
+RUN_INLINE void run_copy(uint16_t *p, int step, int n, const uint16_t *src) {
+    if (step == 1) {
+        kernels->copy(p, src, n);
+        return;
+    }
+    for (; n > 0; n--) {
+        *p = *src++;
+        p += step;
+    }
+}
+
+/* Blend n > 0 pixels of src over p with per-pixel alpha (0 = keep,
+ * 255 = src), p moving step apart */
+RUN_INLINE void run_blend(uint16_t *p, int step, int n, const uint16_t *src,
+                          const uint8_t *alpha) {
+    if (step == 1) {
+        kernels->blend(p, src, alpha, n);
+        return;
+    }
+    for (; n > 0; n--, src++, p += step) {
+        uint8_t a = *alpha++;
+        if (a == 0) continue;
+        *p = a == 255 ? *src : blend_rgb565(*src, *p, a);
+    }
+}
+
+#define DEFINE_SPAN_OPS(NAME, BUF, ORIGIN, XSTEP, YSTEP)                           \
+    static inline uint16_t *NAME##_at(int x, int y) {                               \
+        return (BUF) + (ORIGIN) + x * (XSTEP) + y * (YSTEP);                        \
+    }                                                                               \
+    static void NAME##_fill(int x1, int x2, int y, uint16_t color) {                \
+        run_fill(NAME##_at(x1, y), XSTEP, x2 - x1, color);                          \
+    }                                                                               \
+    static void NAME##_tint(int x1, int x2, int y, uint16_t color, uint32_t alpha) {\
+        run_tint(NAME##_at(x1, y), XSTEP, x2 - x1, color, alpha);                   \
+    }                                                                               \
+    static void NAME##_copy(int x1, int x2, int y, const uint16_t *src) {           \
+        run_copy(NAME##_at(x1, y), XSTEP, x2 - x1, src);                            \
+    }                                                                               \
+    static void NAME##_blend(int x1, int x2, int y, const uint16_t *src,            \
+                             const uint8_t *alpha) {                                \
+        run_blend(NAME##_at(x1, y), XSTEP, x2 - x1, src, alpha);                    \
+    }                                                                               \
+    static void NAME##_vfill(int x, int y1, int y2, uint16_t color) {               \
+        run_fill(NAME##_at(x, y1), YSTEP, y2 - y1, color);                          \
+    }                                                                               \
+    static const span_ops_t NAME = {                                                \
+        ORIGIN, XSTEP, YSTEP,                                                       \
+        NAME##_fill, NAME##_tint, NAME##_copy, NAME##_blend, NAME##_vfill,          \
+    }
+
+/* Rows in order: the framebuffer at 0 degrees, or logical_buf */
+DEFINE_SPAN_OPS(spans_narrow, logical_buf ? logical_buf : framebuffer,
+                0, 1, PAGER_FB_WIDTH);
+DEFINE_SPAN_OPS(spans_wide, logical_buf ? logical_buf : framebuffer,
+                0, 1, PAGER_FB_HEIGHT);
+
+/* The framebuffer under rotation, as in transform_coords() */
+DEFINE_SPAN_OPS(spans_rot90, framebuffer,
+                (PAGER_FB_HEIGHT - 1) * PAGER_FB_WIDTH, -PAGER_FB_WIDTH, 1);
+DEFINE_SPAN_OPS(spans_rot180, framebuffer,
+                (PAGER_FB_HEIGHT - 1) * PAGER_FB_WIDTH + PAGER_FB_WIDTH - 1, -1, -PAGER_FB_WIDTH);
+DEFINE_SPAN_OPS(spans_rot270, framebuffer,
+                PAGER_FB_WIDTH - 1, PAGER_FB_WIDTH, -1);
+
+static const span_ops_t *spans = &spans_narrow;
+
+/* Pick the span writers after the rotation or the draw buffer changes */
+static void select_spans(void) {
+    const span_ops_t *direct = NULL;
     switch (current_rotation) {
-        case ROTATION_0:   /* No rotation */
-            *fx = lx;
-            *fy = ly;
-            break;
-        case ROTATION_90:  /* 90° CW: (lx,ly) -> (ly, 479-lx) for 480x222 logical */
-            *fx = ly;
-            *fy = PAGER_FB_HEIGHT - 1 - lx;
-            break;
-        case ROTATION_180: /* 180°: (lx,ly) -> (221-lx, 479-ly) */
-            *fx = PAGER_FB_WIDTH - 1 - lx;
-            *fy = PAGER_FB_HEIGHT - 1 - ly;
-            break;
-        case ROTATION_270: /* 270° CW (90° CCW): (lx,ly) -> (221-ly, lx) for 480x222 logical */
-            *fx = PAGER_FB_WIDTH - 1 - ly;
-            *fy = lx;
-            break;
-        default:
-            *fx = lx;
-            *fy = ly;
+        case ROTATION_90:  direct = &spans_rot90;  break;
+        case ROTATION_180: direct = &spans_rot180; break;
+        case ROTATION_270: direct = &spans_rot270; break;
+        default:           break;
+    }
+    if (!logical_buf && direct) {
+        spans = direct;
+    } else {
+        spans = logical_width == PAGER_FB_WIDTH ? &spans_narrow : &spans_wide;
+    }
+}
+
+/* Address of logical pixel (x, y) in the draw buffer; must be on screen */
+static inline uint16_t *pixel_addr(int x, int y) {
+    return (logical_buf ? logical_buf : framebuffer) + spans->origin +
+           x * spans->xstep + y * spans->ystep;
+}
+
+/* Logical pixel write with no checks; (x, y) must be inside the clip */
+static inline void put_pixel(int x, int y, uint16_t color) {
+    *pixel_addr(x, y) = color;
+}
+
+/* Logical pixel read with no checks; (x, y) must be on screen */
+static inline uint16_t peek_pixel(int x, int y) {
+    return *pixel_addr(x, y);
+}
+
+/* Logical pixel write without damage tracking. Callers mark the damaged
+ * area once for the whole primitive instead of once per pixel. */
+static inline void plot_pixel(int x, int y, uint16_t color) {
+    if (x < clip_x1 || x >= clip_x2 || y < clip_y1 || y >= clip_y2) return;
+    put_pixel(x, y, color);
+}
+
+/* Pointer steps in the draw buffer for logical x + 1 and y + 1: a
+ * logical row is a column of the framebuffer at 90/270 and a reversed
+ * row at 180 */
+static inline void pixel_steps(int *xstep, int *ystep) {
+    *xstep = spans->xstep;
+    *ystep = spans->ystep;
+}
+
+/* Fill logical pixels [x1, x2) of row y with no checks and no damage
+ * tracking. The span must be non-empty and inside the clip. */
+static inline void span_fill(int x1, int x2, int y, uint16_t color) {
+    spans->fill(x1, x2, y, color);
+}
+
+/* Blend color over logical pixels [x1, x2) of row y at alpha/32 (1..31),
+ * with the same rules as span_fill() */
+static inline void span_tint(int x1, int x2, int y, uint16_t color, uint32_t alpha) {
+    spans->tint(x1, x2, y, color, alpha);
+}
+
+/* Copy src to logical pixels [x1, x2) of row y, with the same rules as
+ * span_fill() */
+static inline void span_copy(int x1, int x2, int y, const uint16_t *src) {
+    spans->copy(x1, x2, y, src);
+}
+
+/* Fill logical pixels [x1, x2) of row y without damage tracking.
+ * Clips to the clip rectangle. Span-based primitives end up here. */
+static void hspan(int x1, int x2, int y, uint16_t color) {
+    if (y < clip_y1 || y >= clip_y2) return;
+    if (x1 < clip_x1) x1 = clip_x1;
+    if (x2 > clip_x2) x2 = clip_x2;
+    if (x1 >= x2) return;
+    span_fill(x1, x2, y, color);
+}
+
+/* hspan() at alpha/32 (0..32): opaque spans take the fill path */
+static void hspan_blend(int x1, int x2, int y, uint16_t color, uint32_t alpha) {
+    if (alpha >= 32) {
+        hspan(x1, x2, y, color);
+        return;
+    }
+    if (alpha == 0 || y < clip_y1 || y >= clip_y2) return;
+    if (x1 < clip_x1) x1 = clip_x1;
+    if (x2 > clip_x2) x2 = clip_x2;
+    if (x1 >= x2) return;
+    span_tint(x1, x2, y, color, alpha);
+}
+
+/*
+ * Damage tracking
+ */
+
+/* Mark a framebuffer-space rectangle as damaged (already clipped, exclusive max) */
+static void damage_fb_rect(int fx1, int fy1, int fx2, int fy2) {
+    if (fx1 >= fx2 || fy1 >= fy2) return;
+
+    draw_generation++;
+
+    memset(&damage_rows[fy1], 1, fy2 - fy1);
+    if (fx1 < damage_x1) damage_x1 = fx1;
+    if (fy1 < damage_y1) damage_y1 = fy1;
+    if (fx2 > damage_x2) damage_x2 = fx2;
+    if (fy2 > damage_y2) damage_y2 = fy2;
+}
+
+/* Convert a logical rectangle (exclusive max) to a clipped framebuffer
+ * rectangle. Returns 0 if nothing is left after clipping. */
+static int logical_to_fb_rect(int x1, int y1, int x2, int y2, int r[4]) {
+    x1 = MAX(0, x1);
+    y1 = MAX(0, y1);
+    x2 = MIN(logical_width, x2);
+    y2 = MIN(logical_height, y2);
+    if (x1 >= x2 || y1 >= y2) return 0;
+
+    /* Opposite corners map to opposite corners under any rotation */
+    int ax, ay, bx, by;
+    transform_coords(x1, y1, &ax, &ay);
+    transform_coords(x2 - 1, y2 - 1, &bx, &by);
+    r[0] = MIN(ax, bx);
+    r[1] = MIN(ay, by);
+    r[2] = MAX(ax, bx) + 1;
+    r[3] = MAX(ay, by) + 1;
+    return 1;
+}
+
+/* Mark a logical rectangle as damaged (exclusive max, clipped here) */
+static void damage_rect(int x1, int y1, int x2, int y2) {
+    int r[4];
+    if (clip_rect(&x1, &y1, &x2, &y2) && logical_to_fb_rect(x1, y1, x2, y2, r)) {
+        damage_fb_rect(r[0], r[1], r[2], r[3]);
+    }
+}
+
+/* damage_rect() for shapes whose bounds may not fit in an int */
+static void damage_rect64(int64_t x1, int64_t y1, int64_t x2, int64_t y2) {
+    if (x2 <= clip_x1 || x1 >= clip_x2 || y2 <= clip_y1 || y1 >= clip_y2) return;
+    damage_rect((int)MAX(x1, clip_x1), (int)MAX(y1, clip_y1),
+                (int)MIN(x2, clip_x2), (int)MIN(y2, clip_y2));
+}
+
+static int damage_empty(void) {
+    return damage_x1 >= damage_x2 || damage_y1 >= damage_y2;
+}
+
+/* Explicitly forced damage is sent even if row differencing thinks
+ * the rows are unchanged (e.g. someone else wrote to the display) */
+void pager_damage_rect(int x, int y, int w, int h) {
+    int r[4];
+    if (w <= 0 || h <= 0) return;
+    if (!logical_to_fb_rect(x, y, x + w, y + h, r)) return;
+
+    damage_fb_rect(r[0], r[1], r[2], r[3]);
+    memset(&row_hash_valid[r[1]], 0, r[3] - r[1]);
+}
+
+void pager_damage_all(void) {
+    damage_fb_rect(0, 0, PAGER_FB_WIDTH, PAGER_FB_HEIGHT);
+    memset(row_hash_valid, 0, sizeof(row_hash_valid));
+}
+
+/* Forget the damage once it has been presented */
+static void damage_reset(void) {
+    presented_generation = draw_generation;
+    memset(damage_rows, 0, sizeof(damage_rows));
+    damage_x1 = PAGER_FB_WIDTH;
+    damage_y1 = PAGER_FB_HEIGHT;
+    damage_x2 = 0;
+    damage_y2 = 0;
+}
+
+void pager_clear_damage(void) {
+    /* In logical mode nothing reached the framebuffer yet */
+    if (!logical_buf) {
+        for (int y = 0; y < PAGER_FB_HEIGHT; y++) {
+            discarded_rows[y] |= damage_rows[y];
+        }
+    }
+    damage_reset();
+}
+
+int pager_get_damage(int *x, int *y, int *w, int *h) {
+    int lx1 = 0, ly1 = 0, lx2 = 0, ly2 = 0;
+
+    if (!damage_empty()) {
+        /* Inverse of transform_coords() applied to the framebuffer box */
+        int fx1 = damage_x1, fy1 = damage_y1;
+        int fx2 = damage_x2, fy2 = damage_y2;
+        switch (current_rotation) {
+            case ROTATION_90:
+                lx1 = PAGER_FB_HEIGHT - fy2; lx2 = PAGER_FB_HEIGHT - fy1;
+                ly1 = fx1;                   ly2 = fx2;
+                break;
+            case ROTATION_180:
+                lx1 = PAGER_FB_WIDTH - fx2;  lx2 = PAGER_FB_WIDTH - fx1;
+                ly1 = PAGER_FB_HEIGHT - fy2; ly2 = PAGER_FB_HEIGHT - fy1;
+                break;
+            case ROTATION_270:
+                lx1 = fy1;                   lx2 = fy2;
+                ly1 = PAGER_FB_WIDTH - fx2;  ly2 = PAGER_FB_WIDTH - fx1;
+                break;
+            default:
+                lx1 = fx1; lx2 = fx2;
+                ly1 = fy1; ly2 = fy2;
+                break;
+        }
+    }
+
+    if (x) *x = lx1;
+    if (y) *y = ly1;
+    if (w) *w = lx2 - lx1;
+    if (h) *h = ly2 - ly1;
+    return lx2 > lx1;
+}
+
+/* Find the next band of flagged rows at or after *row.
+ * Returns 1 and sets [*start, *end) if found, 0 when no flagged rows remain.
+ * Nearby bands separated by fewer than damage_merge_rows clean rows are joined. */
+static int next_row_band(const uint8_t *rows, int *row, int *start, int *end) {
+    int y = *row;
+    while (y < PAGER_FB_HEIGHT && !rows[y]) y++;
+    if (y >= PAGER_FB_HEIGHT) return 0;
+
+    *start = y;
+    int last = y;
+    while (y < PAGER_FB_HEIGHT && y - last <= damage_merge_rows) {
+        if (rows[y]) last = y;
+        y++;
+    }
+    *end = last + 1;
+    *row = *end;
+    return 1;
+}
+
+/*
+ * Logical render mode
+ */
+
+/* Tile edge for the rotating copy. Both sides of a 16x16 tile stay in cache. */
+#define ROTATE_TILE 16
+
+/* Fill framebuffer rect [fx1,fx2) x [fy1,fy2) from logical_buf.
+ * Each framebuffer pixel reads logical_buf[base + fx*sx + fy*sy]. */
+static void logical_rotate_rect(int fx1, int fy1, int fx2, int fy2) {
+    int base, sx, sy;
+    switch (current_rotation) {
+        case ROTATION_90:   /* lx = 479-fy, ly = fx */
+            base = PAGER_FB_HEIGHT - 1;
+            sx = logical_width;
+            sy = -1;
+            break;
+        case ROTATION_180:  /* lx = 221-fx, ly = 479-fy */
+            base = (PAGER_FB_HEIGHT - 1) * logical_width + PAGER_FB_WIDTH - 1;
+            sx = -1;
+            sy = -logical_width;
+            break;
+        case ROTATION_270:  /* lx = fy, ly = 221-fx */
+            base = (PAGER_FB_WIDTH - 1) * logical_width;
+            sx = -logical_width;
+            sy = 1;
+            break;
+        default:
+            base = 0;
+            sx = 1;
+            sy = logical_width;
+            break;
+    }
+
+    for (int ty = fy1; ty < fy2; ty += ROTATE_TILE) {
+        int ye = MIN(ty + ROTATE_TILE, fy2);
+        for (int tx = fx1; tx < fx2; tx += ROTATE_TILE) {
+            int xe = MIN(tx + ROTATE_TILE, fx2);
+            for (int fy = ty; fy < ye; fy++) {
+                uint16_t *dst = &framebuffer[fy * PAGER_FB_WIDTH + tx];
+                const uint16_t *src = &logical_buf[base + tx * sx + fy * sy];
+                for (int fx = tx; fx < xe; fx++) {
+                    *dst++ = *src;
+                    src += sx;
+                }
+            }
+        }
+    }
+}
+
+/* Rotate the damaged bands into the framebuffer before presenting */
+static void logical_rotate_damage(void) {
+    int row = 0, start, end;
+    while (next_row_band(damage_rows, &row, &start, &end)) {
+        logical_rotate_rect(damage_x1, start, damage_x2, end);
+    }
+}
+
+/* Set up logical_buf for the current rotation, seeded from the framebuffer.
+ * Not needed (and not used) without rotation. Returns -1 on failure. */
+static int logical_attach(void) {
+    if (logical_buf || !framebuffer || current_rotation == ROTATION_0) return 0;
+
+    logical_buf = (uint16_t *)malloc(FB_FRAME_BYTES);
+    if (!logical_buf) return -1;
+    select_spans();
+
+    for (int y = 0; y < logical_height; y++) {
+        for (int x = 0; x < logical_width; x++) {
+            int fx, fy;
+            transform_coords(x, y, &fx, &fy);
+            logical_buf[y * logical_width + x] = framebuffer[fy * PAGER_FB_WIDTH + fx];
+        }
+    }
+    return 0;
+}
+
+/* Release logical_buf, optionally rotating its contents into the framebuffer first */
+static void logical_detach(int flush) {
+    if (!logical_buf) return;
+
+    if (flush && framebuffer) {
+        logical_rotate_rect(0, 0, PAGER_FB_WIDTH, PAGER_FB_HEIGHT);
+    }
+    free(logical_buf);
+    logical_buf = NULL;
+    select_spans();
+}
+
+int pager_set_render_mode(pager_render_mode_t mode) {
+    if (mode == PAGER_RENDER_LOGICAL) {
+        if (!framebuffer) return -1;
+        render_mode = mode;
+        if (logical_attach() < 0) {
+            render_mode = PAGER_RENDER_DIRECT;
+            return -1;
+        }
+    } else {
+        render_mode = PAGER_RENDER_DIRECT;
+        logical_detach(1);
+    }
+    return 0;
+}
+
+pager_render_mode_t pager_get_render_mode(void) {
+    return render_mode;
+}
+
+void pager_cleanup(void) {
+    /* Free TTF font cache */
+    pager_ttf_cleanup();
+
+    /* Drain and stop the presenter thread first */
+    pager_set_async_flip(0);
+
+    /* Drop the logical buffer; the screen is cleared below anyway */
+    logical_detach(0);
+    render_mode = PAGER_RENDER_DIRECT;
+
+    if (framebuffer) {
+        /* Clear screen on exit */
+        memset(framebuffer, 0, PAGER_FB_WIDTH * PAGER_FB_HEIGHT * sizeof(uint16_t));
+        pager_damage_all();
+        pager_flip();
+
+        /* In PAN mode the back buffer lives inside the mapping */
+        if (fb_mode != FB_MODE_PAN) {
+            free(framebuffer);
+        }
+        framebuffer = NULL;
+    }
+
+    fb_release();
+
+    if (input_fd >= 0) {
+        close(input_fd);
+        input_fd = -1;
+    }
+}
+
+/*
+ * Frame management
+ */
+
+/* Send one complete frame down the pipe/FIFO (a pipe has no offsets).
+ * SIGPIPE is blocked for the write, so a reader that exits gives EPIPE
+ * rather than killing the process; any signal that write raised is
+ * consumed before unblocking. On failure the stream is reported and
+ * closed for good. Returns the number of rows sent. */
+static int fb_write_stream(const uint16_t *src) {
+    sigset_t pipe_set, old_set, pending;
+    sigemptyset(&pipe_set);
+    sigaddset(&pipe_set, SIGPIPE);
+    sigpending(&pending);
+    int was_pending = sigismember(&pending, SIGPIPE);
+    pthread_sigmask(SIG_BLOCK, &pipe_set, &old_set);
+
+    const uint8_t *p = (const uint8_t *)src;
+    size_t left = FB_FRAME_BYTES;
+    int err = 0;
+    while (left > 0) {
+        ssize_t n = write(fb_fd, p, left);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) {
+            err = n < 0 ? errno : EIO;
             break;
+        }
+        p += n;
+        left -= n;
+    }
+
+    if (err == EPIPE && !was_pending) {
+        struct timespec zero = { 0, 0 };
+        while (sigtimedwait(&pipe_set, NULL, &zero) < 0 && errno == EINTR) {}
+    }
+    pthread_sigmask(SIG_SETMASK, &old_set, NULL);
+
+    if (err) {
+        fprintf(stderr, "pagerctl: display stream %s, no longer sending frames\n",
+                err == EPIPE ? "closed by its reader" : strerror(err));
+        fb_stream_closed = 1;
+        return 0;
+    }
+    return PAGER_FB_HEIGHT;
+}
+
+/* Send the flagged rows of src to the display (all modes except PAN).
+ * Returns the number of rows sent, including merged gaps. */
+static int fb_write_rows(const uint16_t *src, const uint8_t *rows) {
+    int row = 0, start, end, sent = 0;
+
+    if (fb_stream) {
+        return fb_stream_closed ? 0 : fb_write_stream(src);
+    }
+
+    while (next_row_band(rows, &row, &start, &end)) {
+        sent += end - start;
+        if (fb_mode == FB_MODE_MMAP || fb_mode == FB_MODE_MEMORY) {
+            memcpy(fb_map + (size_t)start * PAGER_STRIDE, &src[start * PAGER_FB_WIDTH],
+                   (end - start) * PAGER_STRIDE);
+        } else {
+            pwrite(fb_fd, &src[start * PAGER_FB_WIDTH],
+                   (end - start) * PAGER_STRIDE, (off_t)start * PAGER_STRIDE);
+        }
+    }
+    return sent;
+}
+
+/* Show the hidden page (PAN mode) and make the old front page the back buffer.
+ * Returns the number of damaged rows presented. */
+static int fb_pan_flip(void) {
+    int row = 0, start, end, sent = 0;
+    int back = !fb_front_page;
+
+    fb_vinfo.xoffset = 0;
+    fb_vinfo.yoffset = back * PAGER_FB_HEIGHT;
+    if (ioctl(fb_fd, FBIOPAN_DISPLAY, &fb_vinfo) < 0) {
+        /* Pan refused: copy into the visible page instead */
+        uint16_t *front = fb_page(fb_front_page);
+        while (next_row_band(damage_rows, &row, &start, &end)) {
+            memcpy(&front[start * PAGER_FB_WIDTH], &framebuffer[start * PAGER_FB_WIDTH],
+                   (end - start) * PAGER_STRIDE);
+            sent += end - start;
+        }
+        return sent;
+    }
+
+    while (next_row_band(damage_rows, &row, &start, &end)) {
+        sent += end - start;
+    }
+
+    /* The old front page becomes the back buffer. It is one frame
+     * behind, so catch up the bands that were just drawn, including any
+     * whose damage was discarded: the whole page went on screen. */
+    uint16_t *shown = fb_page(back);
+    fb_front_page = back;
+    framebuffer = fb_page(!back);
+    for (int y = 0; y < PAGER_FB_HEIGHT; y++) {
+        discarded_rows[y] |= damage_rows[y];
+    }
+    row = 0;
+    while (next_row_band(discarded_rows, &row, &start, &end)) {
+        memcpy(&framebuffer[start * PAGER_FB_WIDTH], &shown[start * PAGER_FB_WIDTH],
+               (end - start) * PAGER_STRIDE);
+    }
+    memset(discarded_rows, 0, sizeof(discarded_rows));
+    return sent;
+}
+
+/*
+ * Asynchronous flip
+ *
+ * A presenter thread owns the device writes. Three buffers rotate between
+ * the caller (back), the hand-off slot (pending) and the presenter
+ * (presenting). If the caller flips again before the presenter picked up
+ * the pending frame, the newer frame replaces it and inherits its rows.
+ */
+
+#define FLIP_BUFFERS 3
+
+static int async_flip = 0;
+static pthread_t flip_thread;
+static pthread_mutex_t flip_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t flip_work_cond = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t flip_done_cond;   /* CLOCK_MONOTONIC, set up on enable */
+static uint16_t *flip_bufs[FLIP_BUFFERS];
+static uint8_t flip_rows[FLIP_BUFFERS][PAGER_FB_HEIGHT];   /* Rows to send when presented */
+static uint8_t flip_stale[FLIP_BUFFERS][PAGER_FB_HEIGHT];  /* Rows behind the newest frame */
+static int flip_back = 0;
+static int flip_pending = -1;
+static int flip_presenting = -1;
+static int flip_stop = 0;
+static uint32_t flip_pending_seq = 0;
+
+/* Fence counters: frames handed to pager_flip() and frames on the panel */
+static uint32_t flip_submitted = 0;
+static uint32_t flip_presented = 0;
+
+static void *flip_thread_main(void *arg) {
+    (void)arg;
+    uint8_t rows[PAGER_FB_HEIGHT];
+
+    pthread_mutex_lock(&flip_mutex);
+    while (1) {
+        while (flip_pending < 0 && !flip_stop) {
+            pthread_cond_wait(&flip_work_cond, &flip_mutex);
+        }
+        if (flip_pending < 0) break;   /* Stopping and fully drained */
+
+        int b = flip_pending;
+        uint32_t seq = flip_pending_seq;
+        flip_pending = -1;
+        flip_presenting = b;
+        memcpy(rows, flip_rows[b], sizeof(rows));
+        memset(flip_rows[b], 0, sizeof(flip_rows[b]));
+        pthread_mutex_unlock(&flip_mutex);
+
+        int sent = fb_write_rows(flip_bufs[b], rows);
+
+        pthread_mutex_lock(&flip_mutex);
+        flip_presenting = -1;
+        flip_presented = seq;
+        flip_stats.frames_presented++;
+        flip_stats.rows_written += sent;
+        flip_stats.bytes_written += (uint64_t)sent * PAGER_STRIDE;
+        pthread_cond_broadcast(&flip_done_cond);
+    }
+    pthread_mutex_unlock(&flip_mutex);
+    return NULL;
+}
+
+/* Hand the back buffer to the presenter and pick up a fresh one */
+static void async_submit(void) {
+    int b = flip_back;
+
+    pthread_mutex_lock(&flip_mutex);
+
+    for (int y = 0; y < PAGER_FB_HEIGHT; y++) {
+        flip_rows[b][y] |= damage_rows[y];
+    }
+    for (int i = 0; i < FLIP_BUFFERS; i++) {
+        if (i == b) continue;
+        for (int y = 0; y < PAGER_FB_HEIGHT; y++) {
+            flip_stale[i][y] |= damage_rows[y] | discarded_rows[y];
+        }
+    }
+    memset(discarded_rows, 0, sizeof(discarded_rows));
+
+    int next;
+    if (flip_pending >= 0) {
+        /* Presenter is still busy: drop the queued frame, keep its rows */
+        next = flip_pending;
+        for (int y = 0; y < PAGER_FB_HEIGHT; y++) {
+            flip_rows[b][y] |= flip_rows[next][y];
+        }
+        memset(flip_rows[next], 0, sizeof(flip_rows[next]));
+    } else {
+        next = (b + 1) % FLIP_BUFFERS;
+        if (next == flip_presenting) next = (next + 1) % FLIP_BUFFERS;
+    }
+
+    flip_pending = b;
+    flip_pending_seq = ++flip_submitted;
+    pthread_cond_signal(&flip_work_cond);
+    pthread_mutex_unlock(&flip_mutex);
+
+    /* Bring the new back buffer up to date with the frame just submitted.
+     * Both sides are only read by the presenter, so no lock is needed. */
+    int row = 0, start, end;
+    while (next_row_band(flip_stale[next], &row, &start, &end)) {
+        memcpy(&flip_bufs[next][start * PAGER_FB_WIDTH], &flip_bufs[b][start * PAGER_FB_WIDTH],
+               (end - start) * PAGER_STRIDE);
+    }
+    memset(flip_stale[next], 0, sizeof(flip_stale[next]));
+
+    flip_back = next;
+    framebuffer = flip_bufs[next];
+}
+
+int pager_set_async_flip(int enable) {
+    if (enable && async_flip) return 0;
+    if (!enable && !async_flip) return 0;
+
+    if (enable) {
+        /* Page flipping already presents without copying */
+        if (!framebuffer || fb_mode == FB_MODE_PAN) return -1;
+
+        flip_bufs[0] = framebuffer;
+        for (int i = 1; i < FLIP_BUFFERS; i++) {
+            flip_bufs[i] = (uint16_t *)malloc(FB_FRAME_BYTES);
+            if (!flip_bufs[i]) {
+                while (--i > 0) free(flip_bufs[i]);
+                return -1;
+            }
+            memcpy(flip_bufs[i], framebuffer, FB_FRAME_BYTES);
+        }
+
+        pthread_condattr_t attr;
+        pthread_condattr_init(&attr);
+        pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+        pthread_cond_init(&flip_done_cond, &attr);
+        pthread_condattr_destroy(&attr);
+
+        memset(flip_rows, 0, sizeof(flip_rows));
+        memset(flip_stale, 0, sizeof(flip_stale));
+        flip_back = 0;
+        flip_pending = -1;
+        flip_presenting = -1;
+        flip_stop = 0;
+
+        if (pthread_create(&flip_thread, NULL, flip_thread_main, NULL) != 0) {
+            for (int i = 1; i < FLIP_BUFFERS; i++) free(flip_bufs[i]);
+            pthread_cond_destroy(&flip_done_cond);
+            return -1;
+        }
+        async_flip = 1;
+        return 0;
+    }
+
+    /* Let the presenter drain the queued frame, then stop it */
+    pthread_mutex_lock(&flip_mutex);
+    flip_stop = 1;
+    pthread_cond_signal(&flip_work_cond);
+    pthread_mutex_unlock(&flip_mutex);
+    pthread_join(flip_thread, NULL);
+    pthread_cond_destroy(&flip_done_cond);
+
+    /* Keep the current back buffer, release the other two */
+    for (int i = 0; i < FLIP_BUFFERS; i++) {
+        if (i != flip_back) free(flip_bufs[i]);
+        flip_bufs[i] = NULL;
+    }
+    async_flip = 0;
+    return 0;
+}
+
+int pager_get_async_flip(void) {
+    return async_flip;
+}
+
+uint32_t pager_flip_fence(void) {
+    pthread_mutex_lock(&flip_mutex);
+    uint32_t fence = flip_submitted;
+    pthread_mutex_unlock(&flip_mutex);
+    return fence;
+}
+
+int pager_flip_wait(uint32_t fence, int timeout_ms) {
+    int result = 0;
+
+    pthread_mutex_lock(&flip_mutex);
+    if (async_flip) {
+        struct timespec deadline;
+        clock_gettime(CLOCK_MONOTONIC, &deadline);
+        if (timeout_ms > 0) {
+            deadline.tv_sec += timeout_ms / 1000;
+            deadline.tv_nsec += (long)(timeout_ms % 1000) * 1000000L;
+            if (deadline.tv_nsec >= 1000000000L) {
+                deadline.tv_sec++;
+                deadline.tv_nsec -= 1000000000L;
+            }
+        }
+
+        /* Sequence numbers wrap, so compare by signed difference */
+        while ((int32_t)(flip_presented - fence) < 0) {
+            if (timeout_ms == 0) {
+                result = -1;
+                break;
+            }
+            if (timeout_ms < 0) {
+                pthread_cond_wait(&flip_done_cond, &flip_mutex);
+            } else if (pthread_cond_timedwait(&flip_done_cond, &flip_mutex, &deadline) == ETIMEDOUT) {
+                result = (int32_t)(flip_presented - fence) < 0 ? -1 : 0;
+                break;
+            }
+        }
+    }
+    pthread_mutex_unlock(&flip_mutex);
+    return result;
+}
+
+/* Hash one framebuffer row with two independent 32-bit lanes */
+static void hash_row(const uint16_t *row, uint32_t *ha, uint32_t *hb) {
+    const u32_alias_t *w = (const u32_alias_t *)row;
+    uint32_t a = 2166136261u;   /* FNV-1a */
+    uint32_t b = 0x9E3779B9u;
+
+    for (int i = 0; i < PAGER_STRIDE / 4; i++) {
+        a = (a ^ w[i]) * 16777619u;
+        b = (b + w[i]) * 0x85EBCA6Bu;
+        b ^= b >> 13;
+    }
+    *ha = a;
+    *hb = b;
+}
+
+/* Drop damaged rows that match what was last handed to the display.
+ * Returns the number of damaged rows left. */
+static int diff_damage_rows(void) {
+    int left = 0, skipped = 0;
+
+    for (int y = damage_y1; y < damage_y2; y++) {
+        if (!damage_rows[y]) continue;
+
+        uint32_t ha, hb;
+        hash_row(&framebuffer[y * PAGER_FB_WIDTH], &ha, &hb);
+        if (row_hash_valid[y] && row_hash_a[y] == ha && row_hash_b[y] == hb) {
+            damage_rows[y] = 0;
+            skipped++;
+        } else {
+            row_hash_a[y] = ha;
+            row_hash_b[y] = hb;
+            row_hash_valid[y] = 1;
+            left++;
+        }
+    }
+
+    pthread_mutex_lock(&flip_mutex);
+    flip_stats.rows_skipped += skipped;
+    flip_stats.bytes_saved += (uint64_t)skipped * PAGER_STRIDE;
+    pthread_mutex_unlock(&flip_mutex);
+    return left;
+}
+
+/* Count a flip that found nothing to send */
+static int flip_elided(void) {
+    pthread_mutex_lock(&flip_mutex);
+    flip_stats.frames_elided++;
+    pthread_mutex_unlock(&flip_mutex);
+    return 0;
+}
+
+int pager_flip(void) {
+    if (!framebuffer) return 0;
+
+    /* Nothing drawn since the last present: no write, no presenter wakeup */
+    if (draw_generation == presented_generation || damage_empty()) {
+        return flip_elided();
+    }
+
+    /* Logical render mode: one rotating copy of what changed */
+    if (logical_buf) logical_rotate_damage();
+
+    if (row_diff && diff_damage_rows() == 0) {
+        damage_reset();
+        return flip_elided();
+    }
+
+    if (async_flip) {
+        async_submit();
+    } else {
+        int sent;
+        if (fb_mode == FB_MODE_PAN) {
+            sent = fb_pan_flip();
+        } else {
+            sent = fb_write_rows(framebuffer, damage_rows);
+        }
+
+        pthread_mutex_lock(&flip_mutex);
+        flip_presented = ++flip_submitted;
+        flip_stats.frames_presented++;
+        flip_stats.rows_written += sent;
+        flip_stats.bytes_written += (uint64_t)sent * PAGER_STRIDE;
+        pthread_mutex_unlock(&flip_mutex);
+    }
+
+    damage_reset();
+    return 1;
+}
+
+uint32_t pager_get_generation(void) {
+    return draw_generation;
+}
+
+void pager_set_row_diff(int enable) {
+    if (enable && !row_diff) {
+        /* Nothing is known about the panel contents yet */
+        memset(row_hash_valid, 0, sizeof(row_hash_valid));
+    }
+    row_diff = enable ? 1 : 0;
+}
+
+int pager_get_row_diff(void) {
+    return row_diff;
+}
+
+void pager_get_flip_stats(pager_flip_stats_t *stats) {
+    if (!stats) return;
+
+    pthread_mutex_lock(&flip_mutex);
+    *stats = flip_stats;
+    pthread_mutex_unlock(&flip_mutex);
+}
+
+void pager_reset_flip_stats(void) {
+    pthread_mutex_lock(&flip_mutex);
+    memset(&flip_stats, 0, sizeof(flip_stats));
+    pthread_mutex_unlock(&flip_mutex);
+}
+
+const char *pager_get_backend(void) {
+    if (!framebuffer) return "none";
+
+    switch (fb_mode) {
+        case FB_MODE_PAN:    return "fb-pan";
+        case FB_MODE_MMAP:   return "fb-mmap";
+        case FB_MODE_MEMORY: return "memory";
+        case FB_MODE_FILE:   return "file";
+        default:             return "fb-write";
+    }
+}
+
+void pager_clear(uint16_t color) {
+    if (!framebuffer) return;
+
+    /* With a clip set, only the clipped area is cleared */
+    if (!clip_contains(0, 0, logical_width, logical_height)) {
+        pager_fill_rect(clip_x1, clip_y1, clip_x2 - clip_x1, clip_y2 - clip_y1, color);
+        return;
+    }
+
+    damage_fb_rect(0, 0, PAGER_FB_WIDTH, PAGER_FB_HEIGHT);
+
+    uint16_t *buf = logical_buf ? logical_buf : framebuffer;
+    if ((color >> 8) == (color & 0xFF)) {
+        /* Both bytes equal (black, white, ...): memset is fastest */
+        memset(buf, color & 0xFF, PAGER_FB_WIDTH * PAGER_FB_HEIGHT * sizeof(uint16_t));
+    } else {
+        kernels->fill(buf, color, PAGER_FB_WIDTH * PAGER_FB_HEIGHT);
+    }
+}
+
+uint32_t pager_get_ticks(void) {
+    return (uint32_t)((monotonic_ns() - start_ns) / 1000000);
+}
+
+void pager_delay(uint32_t ms) {
+    usleep(ms * 1000);
+}
+
+/*
+ * Frame pacing
+ *
+ * Frames are paced against absolute CLOCK_MONOTONIC deadlines spaced one
+ * period apart, so time spent rendering or oversleeping does not shift
+ * later frames. The policy decides what happens when a frame is late.
+ */
+
+/* Late by more than this many periods, CATCHUP gives up and resyncs */
+#define FRAME_CATCHUP_MAX 3
+
+static int frame_target_fps = PAGER_TARGET_FPS;  /* 0 = calibrated rate */
+static int64_t frame_period_ns = 1000000000LL / PAGER_TARGET_FPS;
+static int64_t frame_deadline = 0;     /* 0 = not started */
+static int64_t frame_last = 0;         /* When the previous frame_sync returned */
+static pager_frame_policy_t frame_policy = PAGER_FRAME_SKIP;
+static pager_frame_info_t frame_info;
+
+uint32_t pager_frame_sync(void) {
+    int64_t now = monotonic_ns();
+    int64_t late = 0;
+
+    if (frame_deadline == 0) {
+        /* First frame: start the schedule now */
+        frame_deadline = now;
+    } else {
+        frame_deadline += frame_period_ns;
+
+        /* Measured against the missed deadline, before the policy moves it */
+        late = now - frame_deadline;
+
+        if (now > frame_deadline) {
+            int64_t behind = (now - frame_deadline) / frame_period_ns;
+            frame_info.frames_late++;
+
+            if (frame_policy == PAGER_FRAME_SKIP) {
+                /* Drop the missed slots and wait for the next one on the grid */
+                frame_deadline += (behind + 1) * frame_period_ns;
+                frame_info.frames_skipped += (uint32_t)(behind + 1);
+            } else if (behind >= FRAME_CATCHUP_MAX) {
+                /* Too far behind to catch up: resync to now */
+                frame_deadline = now;
+            }
+            /* Otherwise CATCHUP returns at once so later frames make up the time */
+        }
+
+        if (frame_deadline > now) {
+            sleep_until_ns(frame_deadline);
+            now = monotonic_ns();
+        }
+    }
+
+    frame_info.late_us = (int32_t)(late > 0 ? late / 1000 : 0);
+    frame_info.frame_us = frame_last ? (uint32_t)((now - frame_last) / 1000) : 0;
+    frame_info.frames++;
+    frame_last = now;
+
+    return frame_info.frame_us / 1000;
+}
+
+void pager_set_frame_policy(pager_frame_policy_t policy) {
+    frame_policy = policy;
+}
+
+void pager_reset_frame_sync(void) {
+    frame_deadline = 0;
+    frame_last = 0;
+    memset(&frame_info, 0, sizeof(frame_info));
+}
+
+void pager_get_frame_info(pager_frame_info_t *info) {
+    if (info) *info = frame_info;
+}
+
+/*
+ * Target frame rate and SPI calibration
+ */
+
+static pager_calibration_t calibration;
+static int calibrated = 0;
+
+/* Recompute the frame period from the target (or calibrated) rate */
+static void update_frame_period(void) {
+    int fps = frame_target_fps;
+    if (fps <= 0) {
+        fps = (calibrated && calibration.max_fps > 0) ? (int)calibration.max_fps : PAGER_TARGET_FPS;
+    }
+    frame_period_ns = 1000000000LL / fps;
+}
+
+void pager_set_target_fps(int fps) {
+    frame_target_fps = fps > 0 ? fps : 0;
+    update_frame_period();
+}
+
+int pager_get_target_fps(void) {
+    return (int)(1000000000LL / frame_period_ns);
+}
+
+int pager_calibrate(int frames, pager_calibration_t *result) {
+    if (!framebuffer || frames <= 0) return -1;
+
+    /* Let the presenter thread go idle so we own the device */
+    if (async_flip) pager_flip_wait(pager_flip_fence(), -1);
+
+    uint8_t all_rows[PAGER_FB_HEIGHT];
+    uint8_t one_row[PAGER_FB_HEIGHT];
+    memset(all_rows, 1, sizeof(all_rows));
+    memset(one_row, 0, sizeof(one_row));
+    one_row[PAGER_FB_HEIGHT / 2] = 1;
+
+    /* Full frames: the back buffer matches the panel after init, so
+     * re-sending it is invisible */
+    int64_t t0 = monotonic_ns();
+    for (int i = 0; i < frames; i++) {
+        if (fb_mode == FB_MODE_PAN) {
+            ioctl(fb_fd, FBIOPAN_DISPLAY, &fb_vinfo);
+        } else {
+            fb_write_rows(framebuffer, all_rows);
+        }
+    }
+    int64_t frame_ns = (monotonic_ns() - t0) / frames;
+
+    /* Single rows: mostly per-call overhead */
+    int calls = frames * 8;
+    t0 = monotonic_ns();
+    for (int i = 0; i < calls; i++) {
+        if (fb_mode == FB_MODE_PAN) {
+            ioctl(fb_fd, FBIOPAN_DISPLAY, &fb_vinfo);
+        } else {
+            fb_write_rows(framebuffer, one_row);
+        }
+    }
+    int64_t call_ns = (monotonic_ns() - t0) / calls;
+
+    if (frame_ns < 1) frame_ns = 1;
+    calibration.frame_us = (uint32_t)(frame_ns / 1000);
+    calibration.row_call_us = (uint32_t)(call_ns / 1000);
+    calibration.bytes_per_sec = (uint32_t)MIN((int64_t)FB_FRAME_BYTES * 1000000000LL / frame_ns,
+                                              (int64_t)UINT32_MAX);
+    calibration.max_fps = (uint32_t)MIN(1000000000LL / frame_ns, 1000);
+    if (calibration.max_fps < 1) calibration.max_fps = 1;
+    calibrated = 1;
+
+    /* Bridge clean gaps when sending them costs less than another call */
+    int64_t row_ns = frame_ns / PAGER_FB_HEIGHT;
+    int64_t overhead_ns = call_ns - row_ns;
+    if (row_ns > 0 && fb_mode != FB_MODE_PAN) {
+        damage_merge_rows = (int)CLAMP(overhead_ns / row_ns, 1, PAGER_FB_HEIGHT / 4);
+    }
+
+    update_frame_period();
+
+    if (result) *result = calibration;
+    return 0;
+}
+
+int pager_get_calibration(pager_calibration_t *result) {
+    if (!calibrated) return -1;
+    if (result) *result = calibration;
+    return 0;
+}
+
+/*
+ * Drawing primitives
+ */
+
+void pager_set_pixel(int x, int y, uint16_t color) {
+    if (!framebuffer) return;
+    if (x < clip_x1 || x >= clip_x2 || y < clip_y1 || y >= clip_y2) return;
+
+    int fx, fy;
+    transform_coords(x, y, &fx, &fy);
+    put_pixel(x, y, color);
+    damage_fb_rect(fx, fy, fx + 1, fy + 1);
+}
+
+/* A rotated logical rectangle is still a rectangle in the framebuffer,
+ * with contiguous rows. Fill framebuffer rectangle r (from
+ * logical_to_fb_rect()) a row at a time instead of walking logical rows
+ * down framebuffer columns. */
+static void fb_fill_rect(const int r[4], uint16_t color) {
+    int w = r[2] - r[0];
+    uint16_t *p = &framebuffer[r[1] * PAGER_FB_WIDTH + r[0]];
+
+    if (w == PAGER_FB_WIDTH) {
+        kernels->fill(p, color, w * (r[3] - r[1]));
+        return;
+    }
+    for (int fy = r[1]; fy < r[3]; fy++, p += PAGER_FB_WIDTH) {
+        kernels->fill(p, color, w);
+    }
+}
+
+/* fb_fill_rect() blending at alpha/32 (1..31) */
+static void fb_tint_rect(const int r[4], uint16_t color, uint32_t alpha) {
+    int w = r[2] - r[0];
+    uint16_t *p = &framebuffer[r[1] * PAGER_FB_WIDTH + r[0]];
+
+    if (w == PAGER_FB_WIDTH) {
+        kernels->tint(p, color, alpha, w * (r[3] - r[1]));
+        return;
+    }
+    for (int fy = r[1]; fy < r[3]; fy++, p += PAGER_FB_WIDTH) {
+        kernels->tint(p, color, alpha, w);
+    }
+}
+
+void pager_fill_rect(int x, int y, int w, int h, uint16_t color) {
+    if (!framebuffer) return;
+
+    int x1 = x, y1 = y, x2 = x + w, y2 = y + h;
+    if (!clip_rect(&x1, &y1, &x2, &y2)) return;
+
+    damage_rect(x1, y1, x2, y2);
+
+    if (!draw_linear()) {
+        int r[4];
+        if (logical_to_fb_rect(x1, y1, x2, y2, r)) fb_fill_rect(r, color);
+        return;
+    }
+
+    /* Full-width rows are one contiguous span */
+    if (x1 == 0 && x2 == logical_width) {
+        kernels->fill(draw_row(y1), color, (y2 - y1) * logical_width);
+        return;
+    }
+
+    for (int py = y1; py < y2; py++) {
+        kernels->fill(draw_row(py) + x1, color, x2 - x1);
+    }
+}
+
+void pager_fill_rect_alpha(int x, int y, int w, int h, uint16_t color, uint8_t alpha) {
+    if (!framebuffer) return;
+
+    uint32_t a = alpha5(alpha);
+    if (a >= 32) {
+        pager_fill_rect(x, y, w, h, color);
+        return;
+    }
+
+    int x1 = x, y1 = y, x2 = x + w, y2 = y + h;
+    if (a == 0 || !clip_rect(&x1, &y1, &x2, &y2)) return;
+
+    damage_rect(x1, y1, x2, y2);
+
+    if (!draw_linear()) {
+        int r[4];
+        if (logical_to_fb_rect(x1, y1, x2, y2, r)) fb_tint_rect(r, color, a);
+        return;
+    }
+
+    if (x1 == 0 && x2 == logical_width) {
+        kernels->tint(draw_row(y1), color, a, (y2 - y1) * logical_width);
+        return;
+    }
+
+    for (int py = y1; py < y2; py++) {
+        kernels->tint(draw_row(py) + x1, color, a, x2 - x1);
+    }
+}
+
+/* Colour table for a gradient from c0 (position 0) to c1 (position
+ * length - 1): ramp[i] is the colour at position first + i. Channels are
+ * interpolated at 8 bits and rounded once to RGB565. */
+static void build_ramp(uint16_t *ramp, int first, int count, int length, uint16_t c0, uint16_t c1) {
+    int r0 = (c0 >> 11) << 3, g0 = ((c0 >> 5) & 0x3F) << 2, b0 = (c0 & 0x1F) << 3;
+    int r1 = (c1 >> 11) << 3, g1 = ((c1 >> 5) & 0x3F) << 2, b1 = (c1 & 0x1F) << 3;
+    int span = MAX(length - 1, 1);
+
+    for (int i = 0; i < count; i++) {
+        int t = first + i;
+        ramp[i] = rgb888_to_rgb565(r0 + (r1 - r0) * t / span,
+                                   g0 + (g1 - g0) * t / span,
+                                   b0 + (b1 - b0) * t / span);
+    }
+}
+
+void pager_fill_vgradient(int x, int y, int w, int h, uint16_t top, uint16_t bottom) {
+    if (!framebuffer || h <= 0) return;
+
+    int x1 = x, y1 = y, x2 = x + w, y2 = y + h;
+    if (!clip_rect(&x1, &y1, &x2, &y2)) return;
+
+    damage_rect(x1, y1, x2, y2);
+
+    /* One colour per visible row */
+    uint16_t ramp[MAX(PAGER_FB_WIDTH, PAGER_FB_HEIGHT)];
+    build_ramp(ramp, y1 - y, y2 - y1, h, top, bottom);
+    for (int py = y1; py < y2; py++) {
+        span_fill(x1, x2, py, ramp[py - y1]);
+    }
+}
+
+void pager_fill_hgradient(int x, int y, int w, int h, uint16_t left, uint16_t right) {
+    if (!framebuffer || w <= 0) return;
+
+    int x1 = x, y1 = y, x2 = x + w, y2 = y + h;
+    if (!clip_rect(&x1, &y1, &x2, &y2)) return;
+
+    damage_rect(x1, y1, x2, y2);
+
+    /* Every row is the same visible slice of the ramp */
+    uint16_t ramp[MAX(PAGER_FB_WIDTH, PAGER_FB_HEIGHT)];
+    build_ramp(ramp, x1 - x, x2 - x1, w, left, right);
+    for (int py = y1; py < y2; py++) {
+        span_copy(x1, x2, py, ramp);
+    }
+}
+
+/* Move the pixels of rectangle [x1, x2) x [y1, y2) of buf (stride pixels
+ * per row) by (dx, dy), dropping what leaves the rectangle and filling
+ * what is uncovered */
+static void scroll_rect(uint16_t *buf, int stride, int x1, int y1, int x2, int y2,
+                        int dx, int dy, uint16_t fill) {
+    int w = x2 - x1, h = y2 - y1;
+    if (ABS(dx) >= w || ABS(dy) >= h) {
+        for (int y = y1; y < y2; y++) kernels->fill(buf + y * stride + x1, fill, w);
+        return;
+    }
+
+    /* Rows that keep content, walked away from the direction of travel so
+     * no source row is overwritten before it is moved */
+    int keep_w = w - ABS(dx);
+    int src_x = x1 + MAX(-dx, 0);
+    int dst_x = x1 + MAX(dx, 0);
+    int first = y1 + MAX(dy, 0);
+    int last = y2 + MIN(dy, 0);  /* Exclusive */
+    for (int i = 0; i < last - first; i++) {
+        int y = dy > 0 ? last - 1 - i : first + i;
+        memmove(buf + y * stride + dst_x, buf + (y - dy) * stride + src_x,
+                (size_t)keep_w * sizeof(uint16_t));
+        if (dx > 0) kernels->fill(buf + y * stride + x1, fill, dx);
+        if (dx < 0) kernels->fill(buf + y * stride + x2 + dx, fill, -dx);
+    }
+
+    /* Rows uncovered at the top or bottom */
+    for (int y = y1; y < first; y++) kernels->fill(buf + y * stride + x1, fill, w);
+    for (int y = last; y < y2; y++) kernels->fill(buf + y * stride + x1, fill, w);
+}
+
+/* The region is moved in the draw buffer itself: a logical move is a
+ * framebuffer move along permuted axes, so rows stay memmove-able under
+ * every rotation */
+void pager_scroll_region(int x, int y, int w, int h, int dx, int dy, uint16_t fill) {
+    if (!framebuffer) return;
+
+    int x1 = x, y1 = y, x2 = x + w, y2 = y + h;
+    if (!clip_rect(&x1, &y1, &x2, &y2)) return;
+    if (dx == 0 && dy == 0) return;
+
+    damage_rect(x1, y1, x2, y2);
+
+    if (draw_linear()) {
+        scroll_rect(draw_row(0), logical_width, x1, y1, x2, y2, dx, dy, fill);
+        return;
+    }
+
+    int r[4];
+    if (!logical_to_fb_rect(x1, y1, x2, y2, r)) return;
+
+    int fdx, fdy;
+    switch (current_rotation) {
+        case ROTATION_90:  fdx = dy;  fdy = -dx; break;
+        case ROTATION_180: fdx = -dx; fdy = -dy; break;
+        default:           fdx = -dy; fdy = dx;  break;
+    }
+    scroll_rect(framebuffer, PAGER_FB_WIDTH, r[0], r[1], r[2], r[3], fdx, fdy, fill);
+}
+
+void pager_draw_rect(int x, int y, int w, int h, uint16_t color) {
+    pager_hline(x, y, w, color);
+    pager_hline(x, y + h - 1, w, color);
+    pager_vline(x, y, h, color);
+    pager_vline(x + w - 1, y, h, color);
+}
+
+void pager_hline(int x, int y, int w, uint16_t color) {
+    if (!framebuffer) return;
+
+    int x1 = x, y1 = y, x2 = x + w, y2 = y + 1;
+    if (!clip_rect(&x1, &y1, &x2, &y2)) return;
+
+    damage_rect(x1, y, x2, y + 1);
+    span_fill(x1, x2, y, color);
+}
+
+void pager_hline_alpha(int x, int y, int w, uint16_t color, uint8_t alpha) {
+    if (!framebuffer) return;
+
+    int x1 = x, y1 = y, x2 = x + w, y2 = y + 1;
+    if (!clip_rect(&x1, &y1, &x2, &y2)) return;
+
+    damage_rect(x1, y, x2, y + 1);
+    hspan_blend(x1, x2, y, color, alpha5(alpha));
+}
+
+void pager_vline(int x, int y, int h, uint16_t color) {
+    if (!framebuffer) return;
+
+    int x1 = x, y1 = y, x2 = x + 1, y2 = y + h;
+    if (!clip_rect(&x1, &y1, &x2, &y2)) return;
+
+    damage_rect(x, y1, x + 1, y2);
+
+    spans->vfill(x, y1, y2, color);
+}
+
+/* Floor division for a possibly negative numerator */
+static int64_t floor_div(int64_t num, int64_t den) {
+    int64_t q = num / den;
+    if ((num % den) < 0) q--;
+    return q;
+}
+
+/* Steps [first, last] of a line's major axis whose minor axis offset,
+ * floor((2 * i * dmin + dmaj - 1) / (2 * dmaj)), lies in [lo, hi].
+ * Returns 0 if there are none. */
+static int line_minor_range(int64_t dmaj, int64_t dmin, int64_t lo, int64_t hi,
+                            int64_t *first, int64_t *last) {
+    int64_t b = 2 * dmin;
+    int64_t start = -floor_div(-(2 * dmaj * lo - dmaj + 1), b);
+    int64_t end = floor_div(2 * dmaj * (hi + 1) - dmaj, b);
+    *first = MAX(*first, start);
+    *last = MIN(*last, end);
+    return *first <= *last;
+}
+
+/* Bresenham's line, clipped before it is walked. Step i of the major axis
+ * is at minor offset floor((2 * i * dmin + dmaj - 1) / (2 * dmaj)), which
+ * is monotonic, so the steps inside the clip are solved for directly and
+ * only those are walked, with the draw buffer pointer stepped in place.
+ * Horizontal and vertical lines go to the span writers. */
+void pager_draw_line(int x0, int y0, int x1, int y1, uint16_t color) {
+    if (!framebuffer) return;
+
+    if (y0 == y1) {
+        pager_hline(MIN(x0, x1), y0, ABS(x1 - x0) + 1, color);
+        return;
+    }
+    if (x0 == x1) {
+        pager_vline(x0, MIN(y0, y1), ABS(y1 - y0) + 1, color);
+        return;
+    }
+
+    int dx = ABS(x1 - x0);
+    int dy = ABS(y1 - y0);
+    int sx = x0 < x1 ? 1 : -1;
+    int sy = y0 < y1 ? 1 : -1;
+
+    damage_rect(MIN(x0, x1), MIN(y0, y1), MAX(x0, x1) + 1, MAX(y0, y1) + 1);
+
+    /* Offsets from the start point that stay inside the clip, along the
+     * line's direction on each axis */
+    int64_t xlo = sx > 0 ? clip_x1 - x0 : x0 - (clip_x2 - 1);
+    int64_t xhi = sx > 0 ? clip_x2 - 1 - x0 : x0 - clip_x1;
+    int64_t ylo = sy > 0 ? clip_y1 - y0 : y0 - (clip_y2 - 1);
+    int64_t yhi = sy > 0 ? clip_y2 - 1 - y0 : y0 - clip_y1;
+
+    int x_major = dx >= dy;
+    int64_t dmaj = x_major ? dx : dy;
+    int64_t dmin = x_major ? dy : dx;
+    int64_t first = MAX(0, x_major ? xlo : ylo);
+    int64_t last = MIN(dmaj, x_major ? xhi : yhi);
+    if (first > last) return;
+    if (!line_minor_range(dmaj, dmin, x_major ? ylo : xlo, x_major ? yhi : xhi, &first, &last)) return;
+
+    /* Minor offset and its remainder at the first visible step */
+    int64_t num = 2 * first * dmin + dmaj - 1;
+    int64_t minor = num / (2 * dmaj);
+    int64_t rem = num - minor * 2 * dmaj;
+
+    int xstep, ystep;
+    pixel_steps(&xstep, &ystep);
+    int maj_step = x_major ? sx * xstep : sy * ystep;
+    int min_step = x_major ? sy * ystep : sx * xstep;
+
+    uint16_t *p = x_major ? pixel_addr(x0 + sx * (int)first, y0 + sy * (int)minor)
+                          : pixel_addr(x0 + sx * (int)minor, y0 + sy * (int)first);
+    for (int64_t n = last - first; ; n--) {
+        *p = color;
+        if (n == 0) break;
+        p += maj_step;
+        rem += 2 * dmin;
+        if (rem >= 2 * dmaj) {
+            rem -= 2 * dmaj;
+            p += min_step;
+        }
+    }
+}
+
+/* hspan_blend() for rounded_spans(), whose edges may lie beyond int */
+static void rounded_span(int64_t x1, int64_t x2, int64_t y, uint16_t color, uint32_t alpha) {
+    if (y < clip_y1 || y >= clip_y2) return;
+    x1 = MAX(x1, clip_x1);
+    x2 = MIN(x2, clip_x2);
+    if (x1 < x2) hspan_blend((int)x1, (int)x2, (int)y, color, alpha);
+}
+
+/* Emit a rounded box as horizontal spans: an ellipse with radii rx, ry
+ * whose four quadrants are centered on the corners (cx1, cy1) and
+ * (cx2, cy2) of an inner rectangle. With cx1 == cx2 and cy1 == cy2 this
+ * is a plain ellipse.
+ * Fills the points with x^2/rx^2 + y^2/ry^2 <= 1. Rows are walked from
+ * the poles inward, so each row's half width only ever grows. With
+ * outline set, the radii are measured to pixel edges (rx + 0.5), like the
+ * midpoint circle, and only the part of each row outside the next row
+ * toward the pole is drawn, which gives a connected one-pixel outline.
+ * Up to PAGER_MAX_RADIUS the products below fit in int64 and the walk is
+ * exact; larger radii work out each visible row's half width in floating
+ * point instead. Only rows that can reach the clip are visited. */
+static void rounded_spans(int cx1, int cy1, int cx2, int cy2, int rx, int ry,
+                          uint16_t color, uint32_t alpha, int outline) {
+    /* In half-pixel units for the outline, so everything stays integer */
+    int64_t k = outline ? 2 : 1;
+    int64_t ax = outline ? 2 * (int64_t)rx + 1 : rx;
+    int64_t ay = outline ? 2 * (int64_t)ry + 1 : ry;
+    int exact = rx <= PAGER_MAX_RADIUS && ry <= PAGER_MAX_RADIUS;
+    int64_t a2 = exact ? ax * ax : 0;
+    int64_t b2 = exact ? ay * ay : 0;
+    int64_t limit = a2 * b2;
+    int dx = 0;
+
+    /* Rows dy that reach the clip through the top (cy1 - dy) and the
+     * bottom (cy2 + dy) quadrants, walked pole first and merged where they
+     * meet. Each walk starts one row above its range so the outline knows
+     * its neighbour; dx only grows from range to range. */
+    int64_t ranges[2][2] = {
+        { MAX(0, (int64_t)cy1 - clip_y2 + 1), MIN(ry, (int64_t)cy1 - clip_y1) },
+        { MAX(0, (int64_t)clip_y1 - cy2), MIN(ry, (int64_t)clip_y2 - 1 - cy2) },
+    };
+    if (ranges[1][1] > ranges[0][1]) {
+        int64_t t[2] = { ranges[0][0], ranges[0][1] };
+        ranges[0][0] = ranges[1][0];
+        ranges[0][1] = ranges[1][1];
+        ranges[1][0] = t[0];
+        ranges[1][1] = t[1];
+    }
+    if (ranges[1][1] >= ranges[0][0] - 1) {
+        ranges[0][0] = MIN(ranges[0][0], ranges[1][0]);
+        ranges[1][0] = 1;
+        ranges[1][1] = 0;
+    }
+
+    for (int r = 0; r < 2; r++) {
+        int64_t lo = ranges[r][0], hi = ranges[r][1];
+        if (lo > hi) continue;
+        int prev = -1;  /* Half width of the row one step closer to the pole */
+
+        for (int dy = (int)MIN(ry, hi + 1); dy >= lo; dy--) {
+            if (exact) {
+                int64_t yy = (k * dy) * (k * dy) * a2;
+                while (dx < rx && (k * (dx + 1)) * (k * (dx + 1)) * b2 + yy <= limit) dx++;
+            } else {
+                /* x / ax = sqrt(1 - t^2), factored to keep precision near
+                 * t = 1. The nudge keeps points exactly on the edge in. */
+                double t = ay ? (double)(k * dy) / (double)ay : 0.0;
+                double w = (double)ax * sqrt((1.0 - t) * (1.0 + t)) / (double)k;
+                dx = (int)MIN((double)rx, floor(w + w * 1e-12));
+            }
+            if (dy > hi) {
+                prev = dx;
+                continue;
+            }
+
+            int inner = outline ? MIN(prev, dx - 1) : -1;
+            for (int side = 0; side < ((dy || cy1 != cy2) ? 2 : 1); side++) {
+                int64_t y = side ? (int64_t)cy1 - dy : (int64_t)cy2 + dy;
+                if (inner < 0) {
+                    rounded_span((int64_t)cx1 - dx, (int64_t)cx2 + dx + 1, y, color, alpha);
+                } else {
+                    rounded_span((int64_t)cx1 - dx, (int64_t)cx1 - inner, y, color, alpha);
+                    rounded_span((int64_t)cx2 + inner + 1, (int64_t)cx2 + dx + 1, y, color, alpha);
+                }
+            }
+            prev = dx;
+        }
+    }
+
+    /* Straight sides between the corners */
+    int64_t y_start = MAX((int64_t)cy1 + 1, clip_y1);
+    int64_t y_end = MIN(cy2, clip_y2);
+    for (int64_t y = y_start; y < y_end; y++) {
+        if (outline) {
+            rounded_span((int64_t)cx1 - rx, (int64_t)cx1 - rx + 1, y, color, alpha);
+            rounded_span((int64_t)cx2 + rx, (int64_t)cx2 + rx + 1, y, color, alpha);
+        } else {
+            rounded_span((int64_t)cx1 - rx, (int64_t)cx2 + rx + 1, y, color, alpha);
+        }
+    }
+}
+
+void pager_fill_circle(int cx, int cy, int r, uint16_t color) {
+    if (!framebuffer || r < 0) return;
+    damage_rect64((int64_t)cx - r, (int64_t)cy - r, (int64_t)cx + r + 1, (int64_t)cy + r + 1);
+    rounded_spans(cx, cy, cx, cy, r, r, color, 32, 0);
+}
+
+void pager_fill_circle_alpha(int cx, int cy, int r, uint16_t color, uint8_t alpha) {
+    if (!framebuffer || r < 0 || alpha5(alpha) == 0) return;
+    damage_rect64((int64_t)cx - r, (int64_t)cy - r, (int64_t)cx + r + 1, (int64_t)cy + r + 1);
+    rounded_spans(cx, cy, cx, cy, r, r, color, alpha5(alpha), 0);
+}
+
+void pager_fill_ellipse(int cx, int cy, int rx, int ry, uint16_t color) {
+    if (!framebuffer || rx < 0 || ry < 0) return;
+    damage_rect64((int64_t)cx - rx, (int64_t)cy - ry, (int64_t)cx + rx + 1, (int64_t)cy + ry + 1);
+    rounded_spans(cx, cy, cx, cy, rx, ry, color, 32, 0);
+}
+
+void pager_draw_ellipse(int cx, int cy, int rx, int ry, uint16_t color) {
+    if (!framebuffer || rx < 0 || ry < 0) return;
+    damage_rect64((int64_t)cx - rx, (int64_t)cy - ry, (int64_t)cx + rx + 1, (int64_t)cy + ry + 1);
+    rounded_spans(cx, cy, cx, cy, rx, ry, color, 32, 1);
+}
+
+/* Corner radius that fits a w x h box, or -1 if the box is empty */
+static int round_rect_radius(int w, int h, int r) {
+    if (w <= 0 || h <= 0) return -1;
+    return CLAMP(r, 0, (MIN(w, h) - 1) / 2);
+}
+
+void pager_fill_round_rect(int x, int y, int w, int h, int r, uint16_t color) {
+    if (!framebuffer || (r = round_rect_radius(w, h, r)) < 0) return;
+    damage_rect(x, y, x + w, y + h);
+    rounded_spans(x + r, y + r, x + w - 1 - r, y + h - 1 - r, r, r, color, 32, 0);
+}
+
+void pager_draw_round_rect(int x, int y, int w, int h, int r, uint16_t color) {
+    if (!framebuffer || (r = round_rect_radius(w, h, r)) < 0) return;
+    damage_rect(x, y, x + w, y + h);
+    rounded_spans(x + r, y + r, x + w - 1 - r, y + h - 1 - r, r, r, color, 32, 1);
+}
+
+/* Polygon edge for the scanline filler. Scanlines are sampled at pixel
+ * centers and the edge covers rows [y0, y1). The crossing is walked
+ * exactly in integers: x is the first pixel whose center lies at or right
+ * of the edge, err the remainder in [0, den).
+ */
+typedef struct {
+    int y0, y1;
+    int x, step;  /* Crossing and per-scanline advance, whole pixels */
+    int64_t err, den, step_err;
+    int winding;  /* +1 for edges going down, -1 going up */
+} poly_edge_t;
+
+/* Small polygons keep their edge table on the stack */
+#define POLY_STACK_EDGES 32
+
+/* Stroke outlines are placed to 1/16 pixel */
+#define POLY_SUBPIXEL_SHIFT 4
+
+static int poly_edge_cmp(const void *a, const void *b) {
+    return ((const poly_edge_t *)a)->y0 - ((const poly_edge_t *)b)->y0;
+}
+
+/* First scanline whose pixel center is at or below v2 / s2 */
+static int poly_row(int64_t v2, int64_t s2) {
+    return (int)-floor_div(-(v2 - s2 / 2), s2);
+}
+
+/* Fill contours (counts[i] points each, back to back in points) whose
+ * coordinates are in 1/2^shift pixels, with integer coordinates on pixel
+ * corners. Overlaps follow the nonzero winding rule if nonzero is set,
+ * otherwise even-odd. All edges share one scanline pass, so every pixel
+ * is written at most once. */
+static void fill_contours(const pager_point_t *points, const int *counts, int num_contours,
+                          int shift, int nonzero, uint16_t color) {
+    int total = 0;
+    for (int c = 0; c < num_contours; c++) total += counts[c];
+    if (total == 0) return;
+
+    poly_edge_t stack_edges[POLY_STACK_EDGES];
+    poly_edge_t *stack_active[POLY_STACK_EDGES];
+    poly_edge_t *edges = stack_edges;
+    poly_edge_t **active = stack_active;
+    if (total > POLY_STACK_EDGES) {
+        edges = (poly_edge_t *)malloc(total * sizeof(poly_edge_t));
+        active = (poly_edge_t **)malloc(total * sizeof(poly_edge_t *));
+        if (!edges || !active) {
+            free(edges);
+            free(active);
+            return;
+        }
+    }
+
+    /* Coordinates are doubled so that pixel centers are whole units */
+    int64_t s2 = (int64_t)2 << shift;
+    int64_t half = s2 / 2;
+
+    /* Bounds, clipped to the scanlines that will be drawn */
+    int min_x = points[0].x, max_x = points[0].x;
+    int min_y = points[0].y, max_y = points[0].y;
+    for (int i = 1; i < total; i++) {
+        min_x = MIN(min_x, points[i].x);
+        max_x = MAX(max_x, points[i].x);
+        min_y = MIN(min_y, points[i].y);
+        max_y = MAX(max_y, points[i].y);
+    }
+    int y_start = MAX(poly_row(2 * (int64_t)min_y, s2), clip_y1);
+    int y_end = MIN(poly_row(2 * (int64_t)max_y, s2), clip_y2);
+
+    /* Edge table: every edge that crosses a visible pixel center row, top
+     * to bottom, positioned on its first visible scanline */
+    int num_edges = 0;
+    for (int c = 0, base = 0; c < num_contours; base += counts[c++]) {
+        for (int i = 0; i < counts[c]; i++) {
+            pager_point_t a = points[base + i];
+            pager_point_t b = points[base + (i + 1) % counts[c]];
+            int winding = 1;
+            if (a.y > b.y) {
+                pager_point_t t = a;
+                a = b;
+                b = t;
+                winding = -1;
+            }
+            int row0 = poly_row(2 * (int64_t)a.y, s2);
+            int row1 = poly_row(2 * (int64_t)b.y, s2);
+            if (row0 == row1 || row1 <= y_start || row0 >= y_end) continue;
+
+            /* Center crossing on row y, minus half a pixel, over den:
+             * (2 a.x dy - half dy + dx (y s2 + half - 2 a.y)) / (s2 dy) */
+            poly_edge_t *e = &edges[num_edges++];
+            int64_t dx = 2 * ((int64_t)b.x - a.x);
+            int64_t dy = 2 * ((int64_t)b.y - a.y);
+            e->y0 = MAX(row0, y_start);
+            e->y1 = row1;
+            e->winding = winding;
+            e->den = s2 * dy;
+            e->step = (int)floor_div(dx * s2, e->den);
+            e->step_err = dx * s2 - e->step * e->den;
+            int64_t num = 2 * (int64_t)a.x * dy - half * dy + dx * (e->y0 * s2 + half - 2 * (int64_t)a.y);
+            int64_t q = -floor_div(-num, e->den);
+            e->x = (int)q;
+            e->err = q * e->den - num;
+        }
+    }
+    qsort(edges, num_edges, sizeof(poly_edge_t), poly_edge_cmp);
+
+    damage_rect((int)floor_div(min_x, 1 << shift), (int)floor_div(min_y, 1 << shift),
+                (int)-floor_div(-(int64_t)max_x, 1 << shift), (int)-floor_div(-(int64_t)max_y, 1 << shift));
+
+    /* Walk the scanlines with an active edge list */
+    int next = 0, num_active = 0;
+    for (int y = y_start; y < y_end; y++) {
+        while (next < num_edges && edges[next].y0 <= y) {
+            active[num_active++] = &edges[next++];
+        }
+
+        int k = 0;
+        for (int i = 0; i < num_active; i++) {
+            if (active[i]->y1 > y) active[k++] = active[i];
+        }
+        num_active = k;
+
+        /* Order crossings left to right (few edges, nearly sorted) */
+        for (int i = 1; i < num_active; i++) {
+            poly_edge_t *e = active[i];
+            int j = i - 1;
+            while (j >= 0 && active[j]->x > e->x) {
+                active[j + 1] = active[j];
+                j--;
+            }
+            active[j + 1] = e;
+        }
+
+        /* Fill from each crossing into the inside to the next one out */
+        int wind = 0, start = 0;
+        for (int i = 0; i < num_active; i++) {
+            int was_in = nonzero ? wind != 0 : wind & 1;
+            wind += nonzero ? active[i]->winding : 1;
+            int is_in = nonzero ? wind != 0 : wind & 1;
+            if (!was_in && is_in) {
+                start = active[i]->x;
+            } else if (was_in && !is_in && start < active[i]->x) {
+                hspan(start, active[i]->x, y, color);
+            }
+        }
+
+        for (int i = 0; i < num_active; i++) {
+            poly_edge_t *e = active[i];
+            e->x += e->step;
+            e->err -= e->step_err;
+            if (e->err < 0) {
+                e->x++;
+                e->err += e->den;
+            }
+        }
+    }
+
+    if (edges != stack_edges) {
+        free(edges);
+        free(active);
+    }
+}
+
+/* The edge setup in fill_contours() multiplies coordinates together in
+ * int64; keeping them within PAGER_MAX_COORD leaves plenty of headroom */
+static int points_in_range(const pager_point_t *points, int n) {
+    for (int i = 0; i < n; i++) {
+        if (points[i].x < -PAGER_MAX_COORD || points[i].x > PAGER_MAX_COORD ||
+            points[i].y < -PAGER_MAX_COORD || points[i].y > PAGER_MAX_COORD) {
+            return 0;
+        }
     }
+    return 1;
 }
 
-/* Raw pixel write (no rotation, direct to framebuffer) */
-static void raw_set_pixel(int fx, int fy, uint16_t color) {
-    if (!framebuffer) return;
-    if (fx < 0 || fx >= PAGER_FB_WIDTH || fy < 0 || fy >= PAGER_FB_HEIGHT) return;
-    framebuffer[fy * PAGER_FB_WIDTH + fx] = color;
+void pager_fill_polygon(const pager_point_t *points, int n, uint16_t color) {
+    if (!framebuffer || !points || n < 3 || !points_in_range(points, n)) return;
+    fill_contours(points, &n, 1, 0, 0, color);
 }
 
-void pager_cleanup(void) {
-    /* Free TTF font cache */
-    pager_ttf_cleanup();
+void pager_fill_triangle(int x0, int y0, int x1, int y1, int x2, int y2, uint16_t color) {
+    pager_point_t points[3] = { { x0, y0 }, { x1, y1 }, { x2, y2 } };
+    pager_fill_polygon(points, 3, color);
+}
 
-    if (framebuffer) {
-        /* Clear screen on exit */
-        memset(framebuffer, 0, PAGER_FB_WIDTH * PAGER_FB_HEIGHT * sizeof(uint16_t));
-        pager_flip();
+/* Unit circle in Q14 at 32 steps, for round joins */
+static const int16_t unit_circle_q14[32][2] = {
+    { 16384, 0 }, { 16069, 3196 }, { 15137, 6270 }, { 13623, 9102 },
+    { 11585, 11585 }, { 9102, 13623 }, { 6270, 15137 }, { 3196, 16069 },
+    { 0, 16384 }, { -3196, 16069 }, { -6270, 15137 }, { -9102, 13623 },
+    { -11585, 11585 }, { -13623, 9102 }, { -15137, 6270 }, { -16069, 3196 },
+    { -16384, 0 }, { -16069, -3196 }, { -15137, -6270 }, { -13623, -9102 },
+    { -11585, -11585 }, { -9102, -13623 }, { -6270, -15137 }, { -3196, -16069 },
+    { 0, -16384 }, { 3196, -16069 }, { 6270, -15137 }, { 9102, -13623 },
+    { 11585, -11585 }, { 13623, -9102 }, { 15137, -6270 }, { 16069, -3196 },
+};
 
-        free(framebuffer);
-        framebuffer = NULL;
-    }
+#define ROUND_JOIN_POINTS 32
 
-    if (fb_fd >= 0) {
-        close(fb_fd);
-        fb_fd = -1;
-    }
+/* Miters longer than this many half widths become round joins */
+#define MITER_LIMIT 4
 
-    if (input_fd >= 0) {
-        close(input_fd);
-        input_fd = -1;
+static uint32_t isqrt64(uint64_t v) {
+    uint64_t r = 0, bit = (uint64_t)1 << 62;
+    while (bit > v) bit >>= 2;
+    while (bit) {
+        if (v >= r + bit) {
+            v -= r + bit;
+            r = (r >> 1) + bit;
+        } else {
+            r >>= 1;
+        }
+        bit >>= 2;
     }
+    return (uint32_t)r;
 }
 
-/*
- * Frame management
- */
+/* num / den rounded to nearest, den > 0 */
+static int64_t div_round(int64_t num, int64_t den) {
+    return floor_div(2 * num + den, 2 * den);
+}
 
-void pager_flip(void) {
-    if (fb_fd >= 0 && framebuffer) {
-        lseek(fb_fd, 0, SEEK_SET);
-        write(fb_fd, framebuffer, PAGER_FB_WIDTH * PAGER_FB_HEIGHT * sizeof(uint16_t));
+/* Reverse a contour if it winds the negative way, so that overlapping
+ * stroke pieces add up under the nonzero rule */
+static void contour_orient(pager_point_t *p, int n) {
+    int64_t area = 0;
+    for (int i = 0; i < n; i++) {
+        int j = (i + 1) % n;
+        area += (int64_t)p[i].x * p[j].y - (int64_t)p[j].x * p[i].y;
+    }
+    if (area >= 0) return;
+    for (int i = 0, j = n - 1; i < j; i++, j--) {
+        pager_point_t t = p[i];
+        p[i] = p[j];
+        p[j] = t;
     }
 }
 
-void pager_clear(uint16_t color) {
-    if (!framebuffer) return;
+/* The stroke is the union of one quad per segment and one join piece per
+ * bend, all in 1/16 pixels and filled together under the nonzero rule.
+ * Points are pixel centers, so they sit half a pixel into the corner
+ * coordinates the filler uses. */
+void pager_draw_polyline(const pager_point_t *points, int n, int width, uint16_t color) {
+    if (!framebuffer || !points || n < 2) return;
 
-    if (color == 0) {
-        memset(framebuffer, 0, PAGER_FB_WIDTH * PAGER_FB_HEIGHT * sizeof(uint16_t));
-    } else {
-        for (int i = 0; i < PAGER_FB_WIDTH * PAGER_FB_HEIGHT; i++) {
-            framebuffer[i] = color;
+    if (width <= 1) {
+        for (int i = 0; i + 1 < n; i++) {
+            pager_draw_line(points[i].x, points[i].y, points[i + 1].x, points[i + 1].y, color);
         }
+        return;
+    }
+    if (!points_in_range(points, n)) return;
+    width = MIN(width, PAGER_MAX_COORD);
+
+    int max_points = 4 * (n - 1) + ROUND_JOIN_POINTS * (n - 2);
+    pager_point_t *out = (pager_point_t *)malloc(max_points * sizeof(pager_point_t));
+    int *counts = (int *)malloc((2 * n) * sizeof(int));
+    if (!out || !counts) {
+        free(out);
+        free(counts);
+        return;
     }
-}
 
-uint32_t pager_get_ticks(void) {
-    struct timeval now;
-    gettimeofday(&now, NULL);
-    return (uint32_t)((now.tv_sec - start_time.tv_sec) * 1000 +
-                      (now.tv_usec - start_time.tv_usec) / 1000);
-}
+    const int one = 1 << POLY_SUBPIXEL_SHIFT;
+    int64_t h = (int64_t)width * one / 2;
+    int num_out = 0, num_contours = 0;
+    int have_prev = 0;
+    pager_point_t v = { 0, 0 };
+    int64_t pdx = 0, pdy = 0, pox = 0, poy = 0;  /* Previous segment */
+
+    for (int i = 0; i + 1 < n; i++) {
+        int64_t dx = (int64_t)points[i + 1].x - points[i].x;
+        int64_t dy = (int64_t)points[i + 1].y - points[i].y;
+        if (dx == 0 && dy == 0) continue;
+
+        pager_point_t a = { points[i].x * one + one / 2, points[i].y * one + one / 2 };
+        pager_point_t b = { points[i + 1].x * one + one / 2, points[i + 1].y * one + one / 2 };
+
+        /* Left normal scaled to half the width (length kept to 1/256) */
+        int64_t len = isqrt64((uint64_t)(dx * dx + dy * dy) << 16);
+        int64_t ox = div_round(-dy * h * 256, len);
+        int64_t oy = div_round(dx * h * 256, len);
+
+        /* Join with the previous segment at a */
+        int64_t cross = pdx * dy - pdy * dx;
+        int64_t dot = pdx * dx + pdy * dy;
+        if (have_prev && (cross != 0 || dot < 0)) {
+            pager_point_t *j = &out[num_out];
+            int64_t side = cross > 0 ? -1 : 1;  /* The outside of the bend */
+            int64_t hh = h * h;
+            int64_t denom = hh + pox * ox + poy * oy;  /* h^2 (1 + cos) */
+
+            if (denom * MITER_LIMIT * MITER_LIMIT < 2 * hh) {
+                for (int k = 0; k < ROUND_JOIN_POINTS; k++) {
+                    j[k].x = v.x + (int)div_round(h * unit_circle_q14[k][0], 16384);
+                    j[k].y = v.y + (int)div_round(h * unit_circle_q14[k][1], 16384);
+                }
+                counts[num_contours++] = ROUND_JOIN_POINTS;
+                num_out += ROUND_JOIN_POINTS;
+            } else {
+                /* Miter point: v + (o0 + o1) h^2 / (h^2 + o0 . o1) */
+                j[0] = v;
+                j[1].x = v.x + (int)(side * pox);
+                j[1].y = v.y + (int)(side * poy);
+                j[2].x = v.x + (int)div_round(side * (pox + ox) * hh, denom);
+                j[2].y = v.y + (int)div_round(side * (poy + oy) * hh, denom);
+                j[3].x = v.x + (int)(side * ox);
+                j[3].y = v.y + (int)(side * oy);
+                contour_orient(j, 4);
+                counts[num_contours++] = 4;
+                num_out += 4;
+            }
+        }
 
-void pager_delay(uint32_t ms) {
-    usleep(ms * 1000);
-}
+        pager_point_t *q = &out[num_out];
+        q[0].x = a.x + (int)ox; q[0].y = a.y + (int)oy;
+        q[1].x = b.x + (int)ox; q[1].y = b.y + (int)oy;
+        q[2].x = b.x - (int)ox; q[2].y = b.y - (int)oy;
+        q[3].x = a.x - (int)ox; q[3].y = a.y - (int)oy;
+        contour_orient(q, 4);
+        counts[num_contours++] = 4;
+        num_out += 4;
+
+        have_prev = 1;
+        v = b;
+        pdx = dx;
+        pdy = dy;
+        pox = ox;
+        poy = oy;
+    }
 
-uint32_t pager_frame_sync(void) {
-    static uint32_t last_frame = 0;
-    uint32_t now = pager_get_ticks();
-    uint32_t elapsed = now - last_frame;
+    fill_contours(out, counts, num_contours, POLY_SUBPIXEL_SHIFT, 1, color);
 
-    if (elapsed < PAGER_FRAME_MS) {
-        pager_delay(PAGER_FRAME_MS - elapsed);
-        now = pager_get_ticks();
-        elapsed = now - last_frame;
-    }
+    free(out);
+    free(counts);
+}
 
-    last_frame = now;
-    return elapsed;
+/* Plot (cx + a, y) and (cx - a, y) of a circle outline, clipped. Works in
+ * int64 so points of a circle larger than the screen cannot overflow. */
+static inline void circle_row_pair(int64_t cx, int64_t y, int64_t a, uint16_t color) {
+    if (y < clip_y1 || y >= clip_y2) return;
+    if (cx + a >= clip_x1 && cx + a < clip_x2) put_pixel((int)(cx + a), (int)y, color);
+    if (cx - a >= clip_x1 && cx - a < clip_x2) put_pixel((int)(cx - a), (int)y, color);
 }
 
-/*
- * Drawing primitives
- */
+void pager_draw_circle(int cx, int cy, int r, uint16_t color) {
+    if (!framebuffer || r < 0) return;
 
-void pager_set_pixel(int x, int y, uint16_t color) {
-    if (!framebuffer) return;
-    if (x < 0 || x >= logical_width || y < 0 || y >= logical_height) return;
+    /* Cull against the clip once; a circle inside it needs no checks */
+    int64_t bx1 = (int64_t)cx - r, by1 = (int64_t)cy - r;
+    int64_t bx2 = (int64_t)cx + r + 1, by2 = (int64_t)cy + r + 1;
+    if (bx2 <= clip_x1 || bx1 >= clip_x2 || by2 <= clip_y1 || by1 >= clip_y2) return;
+    int inside = bx1 >= clip_x1 && by1 >= clip_y1 && bx2 <= clip_x2 && by2 <= clip_y2;
 
-    int fx, fy;
-    transform_coords(x, y, &fx, &fy);
-    raw_set_pixel(fx, fy, color);
-}
+    int x = r;
+    int y = 0;
+    int64_t err = 0;  /* Grows to about 2r, past int for the largest radii */
 
-void pager_fill_rect(int x, int y, int w, int h, uint16_t color) {
-    if (!framebuffer) return;
+    damage_rect64(bx1, by1, bx2, by2);
 
-    /* Clip to logical screen */
-    int x1 = MAX(0, x);
-    int y1 = MAX(0, y);
-    int x2 = MIN(logical_width, x + w);
-    int y2 = MIN(logical_height, y + h);
-
-    /* For no rotation, use fast path */
-    if (current_rotation == ROTATION_0) {
-        for (int py = y1; py < y2; py++) {
-            uint16_t *row = &framebuffer[py * PAGER_FB_WIDTH + x1];
-            for (int px = x1; px < x2; px++) {
-                *row++ = color;
-            }
+    while (x >= y) {
+        if (inside) {
+            put_pixel(cx + x, cy + y, color);
+            put_pixel(cx + y, cy + x, color);
+            put_pixel(cx - y, cy + x, color);
+            put_pixel(cx - x, cy + y, color);
+            put_pixel(cx - x, cy - y, color);
+            put_pixel(cx - y, cy - x, color);
+            put_pixel(cx + y, cy - x, color);
+            put_pixel(cx + x, cy - y, color);
+        } else {
+            /* One row test covers both points on it */
+            circle_row_pair(cx, (int64_t)cy + y, x, color);
+            circle_row_pair(cx, (int64_t)cy - y, x, color);
+            circle_row_pair(cx, (int64_t)cy + x, y, color);
+            circle_row_pair(cx, (int64_t)cy - x, y, color);
         }
-    } else {
-        /* With rotation, use pager_set_pixel for correctness */
-        for (int py = y1; py < y2; py++) {
-            for (int px = x1; px < x2; px++) {
-                pager_set_pixel(px, py, color);
-            }
+
+        y++;
+        err += 1 + 2 * (int64_t)y;
+        if (2 * (err - x) + 1 > 0) {
+            x--;
+            err += 1 - 2 * (int64_t)x;
         }
     }
 }
 
-void pager_draw_rect(int x, int y, int w, int h, uint16_t color) {
-    pager_hline(x, y, w, color);
-    pager_hline(x, y + h - 1, w, color);
-    pager_vline(x, y, h, color);
-    pager_vline(x + w - 1, y, h, color);
+/* Blend an expanded colour into (x, y) with 8-bit coverage, checking
+ * the clip only if clipped is set (the shape's box is not inside it).
+ * Coverage is cut to the 5-bit alpha of blend_expanded(), which is as
+ * fine as a 5-bit RGB565 channel can show anyway. */
+static inline void plot_coverage(int clipped, int x, int y, uint32_t fg, uint16_t color,
+                                 uint32_t coverage) {
+    if (clipped && (x < clip_x1 || x >= clip_x2 || y < clip_y1 || y >= clip_y2)) return;
+    uint32_t alpha = alpha5(coverage);
+    if (alpha >= 32) {
+        put_pixel(x, y, color);
+    } else if (alpha) {
+        blend_expanded(pixel_addr(x, y), fg, alpha);
+    }
 }
 
-void pager_hline(int x, int y, int w, uint16_t color) {
+/* Wu's line with an integer error accumulator: the 16-bit fraction of the
+ * minor axis position splits each step between the two pixels straddling
+ * the ideal line, and its top 8 bits are the coverage. */
+void pager_draw_line_aa(int x0, int y0, int x1, int y1, uint16_t color) {
     if (!framebuffer) return;
-    if (y < 0 || y >= logical_height) return;
 
-    int x1 = MAX(0, x);
-    int x2 = MIN(logical_width, x + w);
+    int dx = ABS(x1 - x0);
+    int dy = ABS(y1 - y0);
+
+    /* Horizontal, vertical and diagonal lines hit pixel centers exactly */
+    if (dx == 0 || dy == 0 || dx == dy) {
+        pager_draw_line(x0, y0, x1, y1, color);
+        return;
+    }
 
-    if (current_rotation == ROTATION_0) {
-        uint16_t *row = &framebuffer[y * PAGER_FB_WIDTH + x1];
-        for (int px = x1; px < x2; px++) {
-            *row++ = color;
+    if (y0 > y1) {
+        int t = y0; y0 = y1; y1 = t;
+        t = x0; x0 = x1; x1 = t;
+    }
+    int xdir = x0 < x1 ? 1 : -1;
+    uint32_t fg = rgb565_expand(color);
+
+    /* Every pixel with coverage lies in this box */
+    int bx1 = MIN(x0, x1), bx2 = MAX(x0, x1) + 1;
+    int cx1 = bx1, cy1 = y0, cx2 = bx2, cy2 = y1 + 1;
+    if (!clip_rect(&cx1, &cy1, &cx2, &cy2)) return;
+    int clipped = !clip_contains(bx1, y0, bx2, y1 + 1);
+
+    damage_rect(bx1, y0, bx2, y1 + 1);
+
+    plot_coverage(clipped, x0, y0, fg, color, 255);
+    plot_coverage(clipped, x1, y1, fg, color, 255);
+
+    uint16_t err = 0;
+    if (dy > dx) {
+        uint16_t adj = (uint16_t)(((uint32_t)dx << 16) / dy);
+        while (--dy) {
+            uint16_t prev = err;
+            err += adj;
+            if (err <= prev) x0 += xdir;  /* Wrapped: step the minor axis */
+            y0++;
+            uint32_t w = err >> 8;
+            plot_coverage(clipped, x0, y0, fg, color, 255 - w);
+            plot_coverage(clipped, x0 + xdir, y0, fg, color, w);
         }
     } else {
-        for (int px = x1; px < x2; px++) {
-            pager_set_pixel(px, y, color);
+        uint16_t adj = (uint16_t)(((uint32_t)dy << 16) / dx);
+        while (--dx) {
+            uint16_t prev = err;
+            err += adj;
+            if (err <= prev) y0++;
+            x0 += xdir;
+            uint32_t w = err >> 8;
+            plot_coverage(clipped, x0, y0, fg, color, 255 - w);
+            plot_coverage(clipped, x0, y0 + 1, fg, color, w);
         }
     }
 }
 
-void pager_vline(int x, int y, int h, uint16_t color) {
-    if (!framebuffer) return;
-    if (x < 0 || x >= logical_width) return;
+/* Plot (x, y) of the first octant in all eight, skipping the duplicates
+ * on the axes and the diagonal so no pixel is blended twice */
+static void plot_coverage8(int clipped, int cx, int cy, int x, int y, uint32_t fg,
+                           uint16_t color, uint32_t coverage) {
+    plot_coverage(clipped, cx + x, cy + y, fg, color, coverage);
+    plot_coverage(clipped, cx + x, cy - y, fg, color, coverage);
+    if (x) {
+        plot_coverage(clipped, cx - x, cy + y, fg, color, coverage);
+        plot_coverage(clipped, cx - x, cy - y, fg, color, coverage);
+    }
+    if (x == y) return;
+    plot_coverage(clipped, cx + y, cy + x, fg, color, coverage);
+    plot_coverage(clipped, cx - y, cy + x, fg, color, coverage);
+    if (x) {
+        plot_coverage(clipped, cx + y, cy - x, fg, color, coverage);
+        plot_coverage(clipped, cx - y, cy - x, fg, color, coverage);
+    }
+}
 
-    int y1 = MAX(0, y);
-    int y2 = MIN(logical_height, y + h);
+/* Wu's circle: for each column of the first octant the exact height
+ * sqrt(r^2 - x^2) = y + f is split between pixels y and y + 1. y and the
+ * remainder r^2 - x^2 - y^2 are stepped incrementally; f is taken as
+ * remainder / (2y + 1), which is exact to within a coverage step. */
+void pager_draw_circle_aa(int cx, int cy, int r, uint16_t color) {
+    if (!framebuffer || r < 0) return;
+
+    /* Keeps rem, 2y + 1 and rem * 255 well inside 32 bits. A circle this
+     * big is all but straight on screen, so nothing is lost by aliasing. */
+    if (r > PAGER_MAX_RADIUS) {
+        pager_draw_circle(cx, cy, r, color);
+        return;
+    }
 
-    if (current_rotation == ROTATION_0) {
-        for (int py = y1; py < y2; py++) {
-            framebuffer[py * PAGER_FB_WIDTH + x] = color;
-        }
-    } else {
-        for (int py = y1; py < y2; py++) {
-            pager_set_pixel(x, py, color);
+    uint32_t fg = rgb565_expand(color);
+    int x = 0;
+    int y = r;
+    int rem = 0;  /* r^2 - x^2 - y^2, kept in [0, 2y + 1) */
+
+    /* Cull against the clip once; a circle inside it needs no checks */
+    int64_t bx1 = (int64_t)cx - r, by1 = (int64_t)cy - r;
+    int64_t bx2 = (int64_t)cx + r + 1, by2 = (int64_t)cy + r + 1;
+    if (bx2 <= clip_x1 || bx1 >= clip_x2 || by2 <= clip_y1 || by1 >= clip_y2) return;
+    int clipped = !(bx1 >= clip_x1 && by1 >= clip_y1 && bx2 <= clip_x2 && by2 <= clip_y2);
+
+    damage_rect64(bx1, by1, bx2, by2);
+
+    while (x <= y) {
+        uint32_t f = (uint32_t)rem * 255u / (uint32_t)(2 * y + 1);
+        plot_coverage8(clipped, cx, cy, x, y, fg, color, 255 - f);
+        if (f) plot_coverage8(clipped, cx, cy, x, y + 1, fg, color, f);
+
+        x++;
+        rem -= 2 * x - 1;
+        while (rem < 0 && y > 0) {
+            rem += 2 * y - 1;
+            y--;
         }
     }
 }
 
-void pager_draw_line(int x0, int y0, int x1, int y1, uint16_t color) {
-    int dx = ABS(x1 - x0);
-    int dy = ABS(y1 - y0);
-    int sx = x0 < x1 ? 1 : -1;
-    int sy = y0 < y1 ? 1 : -1;
-    int err = dx - dy;
-
-    while (1) {
-        pager_set_pixel(x0, y0, color);
-
-        if (x0 == x1 && y0 == y1) break;
+/*
+ * Batched drawing
+ *
+ * One call for many primitives, so callers going through an FFI pay the
+ * call overhead once per batch instead of once per shape.
+ */
 
-        int e2 = 2 * err;
-        if (e2 > -dy) {
-            err -= dy;
-            x0 += sx;
-        }
-        if (e2 < dx) {
-            err += dx;
-            y0 += sy;
-        }
+void pager_set_pixels(const pager_point_t *points, const uint16_t *colors, int n) {
+    if (!framebuffer || !points || !colors || n <= 0) return;
+
+    /* Damage the bounding box of the visible points once */
+    int min_x = clip_x2, min_y = clip_y2, max_x = clip_x1 - 1, max_y = clip_y1 - 1;
+    for (int i = 0; i < n; i++) {
+        int x = points[i].x, y = points[i].y;
+        if (x < clip_x1 || x >= clip_x2 || y < clip_y1 || y >= clip_y2) continue;
+        put_pixel(x, y, colors[i]);
+        min_x = MIN(min_x, x);
+        min_y = MIN(min_y, y);
+        max_x = MAX(max_x, x);
+        max_y = MAX(max_y, y);
     }
+    if (min_x <= max_x) damage_rect(min_x, min_y, max_x + 1, max_y + 1);
 }
 
-void pager_fill_circle(int cx, int cy, int r, uint16_t color) {
-    for (int y = -r; y <= r; y++) {
-        for (int x = -r; x <= r; x++) {
-            if (x*x + y*y <= r*r) {
-                pager_set_pixel(cx + x, cy + y, color);
-            }
-        }
+void pager_fill_rects(const pager_rect_t *rects, int n) {
+    if (!rects) return;
+    for (int i = 0; i < n; i++) {
+        pager_fill_rect(rects[i].x, rects[i].y, rects[i].w, rects[i].h, rects[i].color);
     }
 }
 
-void pager_draw_circle(int cx, int cy, int r, uint16_t color) {
-    int x = r;
-    int y = 0;
-    int err = 0;
-
-    while (x >= y) {
-        pager_set_pixel(cx + x, cy + y, color);
-        pager_set_pixel(cx + y, cy + x, color);
-        pager_set_pixel(cx - y, cy + x, color);
-        pager_set_pixel(cx - x, cy + y, color);
-        pager_set_pixel(cx - x, cy - y, color);
-        pager_set_pixel(cx - y, cy - x, color);
-        pager_set_pixel(cx + y, cy - x, color);
-        pager_set_pixel(cx + x, cy - y, color);
+void pager_draw_lines(const pager_line_t *lines, int n) {
+    if (!lines) return;
+    for (int i = 0; i < n; i++) {
+        pager_draw_line(lines[i].x0, lines[i].y0, lines[i].x1, lines[i].y1, lines[i].color);
+    }
+}
 
-        y++;
-        err += 1 + 2*y;
-        if (2*(err - x) + 1 > 0) {
-            x--;
-            err += 1 - 2*x;
+void pager_draw_circles(const pager_circle_t *circles, int n, int filled) {
+    if (!circles) return;
+    for (int i = 0; i < n; i++) {
+        if (filled) {
+            pager_fill_circle(circles[i].cx, circles[i].cy, circles[i].r, circles[i].color);
+        } else {
+            pager_draw_circle(circles[i].cx, circles[i].cy, circles[i].r, circles[i].color);
         }
     }
 }
@@ -528,20 +3198,27 @@ void pager_draw_circle(int cx, int cy, int r, uint16_t color) {
  */
 
 int pager_draw_char(int x, int y, char c, uint16_t color, font_size_t size) {
+    if (!framebuffer) return 0;
     if (c < FONT_FIRST || c > FONT_LAST) c = '?';
 
     const uint8_t *glyph = font_5x7[c - FONT_FIRST];
     int scale = (int)size;
 
+    damage_rect(x, y, x + FONT_WIDTH * scale, y + FONT_HEIGHT * scale);
+
+    /* Each lit font pixel is a scale x scale block of spans */
+    int inside = clip_contains(x, y, x + FONT_WIDTH * scale, y + FONT_HEIGHT * scale);
     for (int col = 0; col < FONT_WIDTH; col++) {
         uint8_t column = glyph[col];
+        int px = x + col * scale;
         for (int row = 0; row < FONT_HEIGHT; row++) {
             if (column & (1 << row)) {
+                int py = y + row * scale;
                 for (int sy = 0; sy < scale; sy++) {
-                    for (int sx = 0; sx < scale; sx++) {
-                        pager_set_pixel(x + col * scale + sx,
-                                       y + row * scale + sy,
-                                       color);
+                    if (inside) {
+                        span_fill(px, px + scale, py + sy, color);
+                    } else {
+                        hspan(px, px + scale, py + sy, color);
                     }
                 }
             }
@@ -939,15 +3616,15 @@ static void play_rtttl_child_ex(const char *rtttl, int mode) {
 
             /* Start sound if enabled */
             if (use_sound) {
-                FILE *f = fopen("/sys/class/leds/buzzer/frequency", "w");
+                FILE *f = root_fopen(BUZZER_FREQ_PATH, "w");
                 if (f) { fprintf(f, "%d", freq); fclose(f); }
-                f = fopen("/sys/class/leds/buzzer/brightness", "w");
+                f = root_fopen(BUZZER_PATH, "w");
                 if (f) { fprintf(f, "255"); fclose(f); }
             }
 
             /* Start vibration if enabled */
             if (use_vibrate) {
-                FILE *vf = fopen(VIBRATOR_PATH, "w");
+                FILE *vf = root_fopen(VIBRATOR_PATH, "w");
                 if (vf) { fprintf(vf, "1"); fclose(vf); }
             }
 
@@ -955,13 +3632,13 @@ static void play_rtttl_child_ex(const char *rtttl, int mode) {
 
             /* Stop sound */
             if (use_sound) {
-                FILE *f = fopen("/sys/class/leds/buzzer/brightness", "w");
+                FILE *f = root_fopen(BUZZER_PATH, "w");
                 if (f) { fprintf(f, "0"); fclose(f); }
             }
 
             /* Stop vibration */
             if (use_vibrate) {
-                FILE *vf = fopen(VIBRATOR_PATH, "w");
+                FILE *vf = root_fopen(VIBRATOR_PATH, "w");
                 if (vf) { fprintf(vf, "0"); fclose(vf); }
             }
 
@@ -969,7 +3646,7 @@ static void play_rtttl_child_ex(const char *rtttl, int mode) {
         } else {
             /* Rest - ensure vibration is off */
             if (use_vibrate) {
-                FILE *vf = fopen(VIBRATOR_PATH, "w");
+                FILE *vf = root_fopen(VIBRATOR_PATH, "w");
                 if (vf) { fprintf(vf, "0"); fclose(vf); }
             }
             usleep(note_ms * 1000);
@@ -978,11 +3655,11 @@ static void play_rtttl_child_ex(const char *rtttl, int mode) {
 
     /* Ensure everything is off */
     if (use_sound) {
-        FILE *f = fopen("/sys/class/leds/buzzer/brightness", "w");
+        FILE *f = root_fopen(BUZZER_PATH, "w");
         if (f) { fprintf(f, "0"); fclose(f); }
     }
     if (use_vibrate) {
-        FILE *vf = fopen(VIBRATOR_PATH, "w");
+        FILE *vf = root_fopen(VIBRATOR_PATH, "w");
         if (vf) { fprintf(vf, "0"); fclose(vf); }
     }
 }
@@ -1019,11 +3696,11 @@ void pager_play_rtttl_ex(const char *rtttl, rtttl_mode_t mode) {
 
 void pager_stop_audio(void) {
     /* Turn off the buzzer hardware FIRST */
-    FILE *f = fopen("/sys/class/leds/buzzer/brightness", "w");
+    FILE *f = root_fopen(BUZZER_PATH, "w");
     if (f) { fprintf(f, "0"); fclose(f); }
 
     /* Also turn off the vibrator */
-    f = fopen(VIBRATOR_PATH, "w");
+    f = root_fopen(VIBRATOR_PATH, "w");
     if (f) { fprintf(f, "0"); fclose(f); }
 
     if (audio_pid > 0) {
@@ -1037,7 +3714,7 @@ void pager_stop_audio(void) {
     system("killall -9 RINGTONE 2>/dev/null");
 
     /* Turn off buzzer again to be sure */
-    f = fopen("/sys/class/leds/buzzer/brightness", "w");
+    f = root_fopen(BUZZER_PATH, "w");
     if (f) { fprintf(f, "0"); fclose(f); }
 }
 
@@ -1061,10 +3738,10 @@ int pager_audio_playing(void) {
  */
 
 void pager_vibrate(int duration_ms) {
-    FILE *f = fopen(VIBRATOR_PATH, "w");
+    FILE *f = root_fopen(VIBRATOR_PATH, "w");
     if (f) { fprintf(f, "1"); fclose(f); }
     usleep(duration_ms * 1000);
-    f = fopen(VIBRATOR_PATH, "w");
+    f = root_fopen(VIBRATOR_PATH, "w");
     if (f) { fprintf(f, "0"); fclose(f); }
 }
 
@@ -1082,7 +3759,7 @@ void pager_vibrate_pattern(const char *pattern) {
     while (token) {
         int duration = atoi(token);
         if (duration > 0) {
-            f = fopen(VIBRATOR_PATH, "w");
+            f = root_fopen(VIBRATOR_PATH, "w");
             if (f) { fprintf(f, is_on ? "1" : "0"); fclose(f); }
             usleep(duration * 1000);
         }
@@ -1090,7 +3767,7 @@ void pager_vibrate_pattern(const char *pattern) {
         token = strtok(NULL, ",");
     }
     
-    f = fopen(VIBRATOR_PATH, "w");
+    f = root_fopen(VIBRATOR_PATH, "w");
     if (f) { fprintf(f, "0"); fclose(f); }
 }
 
@@ -1107,7 +3784,7 @@ void pager_led_set(const char *name, int brightness) {
 
     char path[256];
     snprintf(path, sizeof(path), "%s/%s/brightness", LED_BASE_PATH, name);
-    FILE *f = fopen(path, "w");
+    FILE *f = root_fopen(path, "w");
     if (f) { fprintf(f, "%d", brightness); fclose(f); }
 }
 
@@ -1118,15 +3795,15 @@ void pager_led_rgb(const char *button, uint8_t r, uint8_t g, uint8_t b) {
     FILE *f;
 
     snprintf(path, sizeof(path), "%s/%s-led-red/brightness", LED_BASE_PATH, button);
-    f = fopen(path, "w");
+    f = root_fopen(path, "w");
     if (f) { fprintf(f, "%d", r); fclose(f); }
 
     snprintf(path, sizeof(path), "%s/%s-led-green/brightness", LED_BASE_PATH, button);
-    f = fopen(path, "w");
+    f = root_fopen(path, "w");
     if (f) { fprintf(f, "%d", g); fclose(f); }
 
     snprintf(path, sizeof(path), "%s/%s-led-blue/brightness", LED_BASE_PATH, button);
-    f = fopen(path, "w");
+    f = root_fopen(path, "w");
     if (f) { fprintf(f, "%d", b); fclose(f); }
 }
 
@@ -1157,15 +3834,15 @@ void pager_led_all_off(void) {
 void pager_beep(int freq, int duration_ms) {
     FILE *f;
     
-    f = fopen("/sys/class/leds/buzzer/frequency", "w");
+    f = root_fopen(BUZZER_FREQ_PATH, "w");
     if (f) { fprintf(f, "%d", freq); fclose(f); }
     
-    f = fopen("/sys/class/leds/buzzer/brightness", "w");
+    f = root_fopen(BUZZER_PATH, "w");
     if (f) { fprintf(f, "255"); fclose(f); }
     
     usleep(duration_ms * 1000);
     
-    f = fopen("/sys/class/leds/buzzer/brightness", "w");
+    f = root_fopen(BUZZER_PATH, "w");
     if (f) { fprintf(f, "0"); fclose(f); }
 }
 
@@ -1269,23 +3946,23 @@ void pager_play_rtttl_sync(const char *rtttl, int with_vibration) {
             else if (oct_diff < 0) for (int i = 0; i < -oct_diff; i++) freq /= 2;
             
             /* Play tone */
-            FILE *f = fopen("/sys/class/leds/buzzer/frequency", "w");
+            FILE *f = root_fopen(BUZZER_FREQ_PATH, "w");
             if (f) { fprintf(f, "%d", freq); fclose(f); }
-            f = fopen("/sys/class/leds/buzzer/brightness", "w");
+            f = root_fopen(BUZZER_PATH, "w");
             if (f) { fprintf(f, "255"); fclose(f); }
             
             if (with_vibration) {
-                vib_f = fopen(VIBRATOR_PATH, "w");
+                vib_f = root_fopen(VIBRATOR_PATH, "w");
                 if (vib_f) { fprintf(vib_f, "1"); fclose(vib_f); }
             }
             
             usleep(note_ms * 900);
             
-            f = fopen("/sys/class/leds/buzzer/brightness", "w");
+            f = root_fopen(BUZZER_PATH, "w");
             if (f) { fprintf(f, "0"); fclose(f); }
             
             if (with_vibration) {
-                vib_f = fopen(VIBRATOR_PATH, "w");
+                vib_f = root_fopen(VIBRATOR_PATH, "w");
                 if (vib_f) { fprintf(vib_f, "0"); fclose(vib_f); }
             }
             
@@ -1293,7 +3970,7 @@ void pager_play_rtttl_sync(const char *rtttl, int with_vibration) {
         } else {
             /* Rest */
             if (with_vibration) {
-                vib_f = fopen(VIBRATOR_PATH, "w");
+                vib_f = root_fopen(VIBRATOR_PATH, "w");
                 if (vib_f) { fprintf(vib_f, "0"); fclose(vib_f); }
             }
             usleep(note_ms * 1000);
@@ -1301,10 +3978,10 @@ void pager_play_rtttl_sync(const char *rtttl, int with_vibration) {
     }
     
     /* Ensure off */
-    FILE *f = fopen("/sys/class/leds/buzzer/brightness", "w");
+    FILE *f = root_fopen(BUZZER_PATH, "w");
     if (f) { fprintf(f, "0"); fclose(f); }
     if (with_vibration) {
-        vib_f = fopen(VIBRATOR_PATH, "w");
+        vib_f = root_fopen(VIBRATOR_PATH, "w");
         if (vib_f) { fprintf(vib_f, "0"); fclose(vib_f); }
     }
 }
@@ -1315,49 +3992,52 @@ void pager_play_rtttl_sync(const char *rtttl, int with_vibration) {
  * ============================================================
  */
 
-/* Cached backlight path (found once on first use) */
-static char backlight_path[256] = {0};
-static int backlight_path_checked = 0;
-static int max_brightness_cached = -1;
-
 /* Find the backlight sysfs path */
 static const char *find_backlight_path(void) {
     if (backlight_path_checked) {
         return backlight_path[0] ? backlight_path : NULL;
     }
+
+    /* Resolve the root first: loading it lazily resets the cache */
+    char base_buf[300];
+    const char *base = root_path(BACKLIGHT_BASE_PATH, base_buf, sizeof(base_buf));
     backlight_path_checked = 1;
 
-    /* Common backlight paths on embedded Linux */
+    /* Common backlight names on embedded Linux */
     const char *candidates[] = {
-        "/sys/class/backlight/backlight",
-        "/sys/class/backlight/lcd-backlight",
-        "/sys/class/backlight/panel0-backlight",
+        "backlight",
+        "lcd-backlight",
+        "panel0-backlight",
         NULL
     };
 
+    char test_path[800];
+
     for (int i = 0; candidates[i]; i++) {
-        char test_path[300];
-        snprintf(test_path, sizeof(test_path), "%s/brightness", candidates[i]);
+        snprintf(test_path, sizeof(test_path), "%s/%s/brightness", base, candidates[i]);
         if (access(test_path, W_OK) == 0) {
-            strncpy(backlight_path, candidates[i], sizeof(backlight_path) - 1);
+            snprintf(backlight_path, sizeof(backlight_path), "%s/%s", base, candidates[i]);
             return backlight_path;
         }
     }
 
-    /* Try glob pattern as fallback */
-    FILE *fp = popen("ls -d /sys/class/backlight/*/brightness 2>/dev/null | head -1", "r");
-    if (fp) {
-        char buf[256];
-        if (fgets(buf, sizeof(buf), fp)) {
-            /* Remove trailing newline and /brightness */
-            char *nl = strchr(buf, '\n');
-            if (nl) *nl = '\0';
-            char *last_slash = strrchr(buf, '/');
-            if (last_slash) *last_slash = '\0';
-            strncpy(backlight_path, buf, sizeof(backlight_path) - 1);
-            backlight_path[sizeof(backlight_path) - 1] = '\0';
+    /* Fall back to the first (by name) device with a brightness file */
+    DIR *dir = opendir(base);
+    if (dir) {
+        char best[256] = {0};
+        struct dirent *de;
+        while ((de = readdir(dir)) != NULL) {
+            if (de->d_name[0] == '.') continue;
+            if (best[0] && strcmp(de->d_name, best) >= 0) continue;
+            snprintf(test_path, sizeof(test_path), "%s/%s/brightness", base, de->d_name);
+            if (access(test_path, F_OK) == 0) {
+                snprintf(best, sizeof(best), "%s", de->d_name);
+            }
+        }
+        closedir(dir);
+        if (best[0]) {
+            snprintf(backlight_path, sizeof(backlight_path), "%s/%s", base, best);
         }
-        pclose(fp);
     }
 
     return backlight_path[0] ? backlight_path : NULL;
@@ -1371,7 +4051,7 @@ int pager_get_max_brightness(void) {
     const char *path = find_backlight_path();
     if (!path) return -1;
 
-    char filepath[300];
+    char filepath[640];
     snprintf(filepath, sizeof(filepath), "%s/max_brightness", path);
 
     FILE *f = fopen(filepath, "r");
@@ -1389,7 +4069,7 @@ int pager_get_brightness(void) {
     const char *path = find_backlight_path();
     if (!path) return -1;
 
-    char filepath[300];
+    char filepath[640];
     snprintf(filepath, sizeof(filepath), "%s/brightness", path);
 
     FILE *f = fopen(filepath, "r");
@@ -1418,7 +4098,7 @@ int pager_set_brightness(int percent) {
 
     int value = (max_val * percent) / 100;
 
-    char filepath[300];
+    char filepath[640];
     snprintf(filepath, sizeof(filepath), "%s/brightness", path);
 
     FILE *f = fopen(filepath, "w");
@@ -1548,13 +4228,19 @@ int pager_draw_ttf(int x, int y, const char *text, uint16_t color,
         unsigned char *bitmap = stbtt_GetCodepointBitmap(font, 0, scale, ch, &w, &h, &xoff, &yoff);
 
         if (bitmap) {
-            /* Draw bitmap with alpha blending */
-            for (int row = 0; row < h; row++) {
-                for (int col = 0; col < w; col++) {
-                    unsigned char alpha = bitmap[row * w + col];
-                    if (alpha > 32) {  /* Threshold for anti-aliasing */
-                        pager_set_pixel(cursor_x + xoff + col,
-                                       y + baseline + yoff + row, color);
+            damage_rect(cursor_x + xoff, y + baseline + yoff,
+                        cursor_x + xoff + w, y + baseline + yoff + h);
+
+            /* Clip the glyph box once */
+            int gx = cursor_x + xoff, gy = y + baseline + yoff;
+            int x1 = gx, y1 = gy, x2 = gx + w, y2 = gy + h;
+            if (clip_rect(&x1, &y1, &x2, &y2)) {
+                for (int py = y1; py < y2; py++) {
+                    const unsigned char *src = &bitmap[(py - gy) * w + (x1 - gx)];
+                    for (int px = x1; px < x2; px++) {
+                        if (*src++ > 32) {  /* Threshold for anti-aliasing */
+                            put_pixel(px, py, color);
+                        }
                     }
                 }
             }
@@ -1644,40 +4330,6 @@ void pager_draw_ttf_right(int y, const char *text, uint16_t color,
  * ============================================================
  */
 
-/* Convert RGB888 to RGB565 */
-static inline uint16_t rgb888_to_rgb565(uint8_t r, uint8_t g, uint8_t b) {
-    return ((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3);
-}
-
-/* Read a pixel from the framebuffer (with rotation transform) */
-static inline uint16_t read_pixel(int x, int y) {
-    if (!framebuffer) return 0;
-    int fx, fy;
-    transform_coords(x, y, &fx, &fy);
-    if (fx < 0 || fx >= PAGER_FB_WIDTH || fy < 0 || fy >= PAGER_FB_HEIGHT) return 0;
-    return framebuffer[fy * PAGER_FB_WIDTH + fx];
-}
-
-/* Alpha-blend foreground RGB565 over background RGB565.
- * Uses >> 8 approximation instead of / 255 for speed on MIPS. */
-static inline uint16_t blend_rgb565(uint16_t fg, uint16_t bg, uint8_t alpha) {
-    uint8_t inv = 255 - alpha;
-
-    uint32_t fg_r = (fg >> 11) & 0x1F;
-    uint32_t fg_g = (fg >> 5)  & 0x3F;
-    uint32_t fg_b = fg & 0x1F;
-
-    uint32_t bg_r = (bg >> 11) & 0x1F;
-    uint32_t bg_g = (bg >> 5)  & 0x3F;
-    uint32_t bg_b = bg & 0x1F;
-
-    uint32_t r = (fg_r * alpha + bg_r * inv) >> 8;
-    uint32_t g = (fg_g * alpha + bg_g * inv) >> 8;
-    uint32_t b = (fg_b * alpha + bg_b * inv) >> 8;
-
-    return (uint16_t)((r << 11) | (g << 5) | b);
-}
-
 /* Load image from file and return pager_image_t structure */
 pager_image_t *pager_load_image(const char *filepath) {
     if (!filepath) return NULL;
@@ -1739,21 +4391,10 @@ pager_image_t *pager_load_image(const char *filepath) {
     img->height = height;
 
     /* Convert to RGB565 and extract alpha */
+    kernels->rgb888_to_565(img->pixels, data, req_channels, width * height);
     if (has_alpha) {
         for (int i = 0; i < width * height; i++) {
-            uint8_t r = data[i * 4 + 0];
-            uint8_t g = data[i * 4 + 1];
-            uint8_t b = data[i * 4 + 2];
-            uint8_t a = data[i * 4 + 3];
-            img->pixels[i] = rgb888_to_rgb565(r, g, b);
-            img->alpha[i] = a;
-        }
-    } else {
-        for (int i = 0; i < width * height; i++) {
-            uint8_t r = data[i * 3 + 0];
-            uint8_t g = data[i * 3 + 1];
-            uint8_t b = data[i * 3 + 2];
-            img->pixels[i] = rgb888_to_rgb565(r, g, b);
+            img->alpha[i] = data[i * 4 + 3];
         }
     }
 
@@ -1774,26 +4415,21 @@ void pager_free_image(pager_image_t *img) {
 void pager_draw_image(int x, int y, const pager_image_t *img) {
     if (!img || !img->pixels || !framebuffer) return;
 
-    for (int iy = 0; iy < img->height; iy++) {
-        int screen_y = y + iy;
-        if (screen_y < 0 || screen_y >= logical_height) continue;
+    int x1 = x, y1 = y, x2 = x + img->width, y2 = y + img->height;
+    if (!clip_rect(&x1, &y1, &x2, &y2)) return;
 
-        for (int ix = 0; ix < img->width; ix++) {
-            int screen_x = x + ix;
-            if (screen_x < 0 || screen_x >= logical_width) continue;
+    damage_rect(x1, y1, x2, y2);
 
-            int src_idx = iy * img->width + ix;
-            uint16_t color = img->pixels[src_idx];
-
-            if (img->alpha) {
-                uint8_t a = img->alpha[src_idx];
-                if (a == 0) continue;
-                if (a < 255) {
-                    color = blend_rgb565(color, read_pixel(screen_x, screen_y), a);
-                }
-            }
+    for (int sy = y1; sy < y2; sy++) {
+        int src_idx = (sy - y) * img->width + (x1 - x);
+        const uint16_t *src = &img->pixels[src_idx];
+        const uint8_t *alpha = img->alpha ? &img->alpha[src_idx] : NULL;
 
-            pager_set_pixel(screen_x, screen_y, color);
+        /* Copy or blend each row in one call */
+        if (alpha) {
+            spans->blend(x1, x2, sy, src, alpha);
+        } else {
+            spans->copy(x1, x2, sy, src);
         }
     }
 }
@@ -1803,19 +4439,18 @@ void pager_draw_image_scaled(int x, int y, int dst_w, int dst_h, const pager_ima
     if (!img || !img->pixels || !framebuffer) return;
     if (dst_w <= 0 || dst_h <= 0) return;
 
-    /* Use nearest-neighbor scaling for speed */
-    for (int dy = 0; dy < dst_h; dy++) {
-        int screen_y = y + dy;
-        if (screen_y < 0 || screen_y >= logical_height) continue;
+    int x1 = x, y1 = y, x2 = x + dst_w, y2 = y + dst_h;
+    if (!clip_rect(&x1, &y1, &x2, &y2)) return;
 
-        int src_y = (dy * img->height) / dst_h;
-        if (src_y >= img->height) src_y = img->height - 1;
+    damage_rect(x1, y1, x2, y2);
 
-        for (int dx = 0; dx < dst_w; dx++) {
-            int screen_x = x + dx;
-            if (screen_x < 0 || screen_x >= logical_width) continue;
+    /* Use nearest-neighbor scaling for speed */
+    for (int screen_y = y1; screen_y < y2; screen_y++) {
+        int src_y = ((screen_y - y) * img->height) / dst_h;
+        if (src_y >= img->height) src_y = img->height - 1;
 
-            int src_x = (dx * img->width) / dst_w;
+        for (int screen_x = x1; screen_x < x2; screen_x++) {
+            int src_x = ((screen_x - x) * img->width) / dst_w;
             if (src_x >= img->width) src_x = img->width - 1;
             int src_idx = src_y * img->width + src_x;
             uint16_t color = img->pixels[src_idx];
@@ -1824,11 +4459,11 @@ void pager_draw_image_scaled(int x, int y, int dst_w, int dst_h, const pager_ima
                 uint8_t a = img->alpha[src_idx];
                 if (a == 0) continue;
                 if (a < 255) {
-                    color = blend_rgb565(color, read_pixel(screen_x, screen_y), a);
+                    color = blend_rgb565(color, peek_pixel(screen_x, screen_y), a);
                 }
             }
 
-            pager_set_pixel(screen_x, screen_y, color);
+            put_pixel(screen_x, screen_y, color);
         }
     }
 }
@@ -1897,19 +4532,18 @@ void pager_draw_image_scaled_rotated(int x, int y, int dst_w, int dst_h,
         rot_h = img->height;
     }
 
-    for (int dy = 0; dy < dst_h; dy++) {
-        int screen_y = y + dy;
-        if (screen_y < 0 || screen_y >= logical_height) continue;
+    int x1 = x, y1 = y, x2 = x + dst_w, y2 = y + dst_h;
+    if (!clip_rect(&x1, &y1, &x2, &y2)) return;
+
+    damage_rect(x1, y1, x2, y2);
 
+    for (int screen_y = y1; screen_y < y2; screen_y++) {
         /* Map to rotated source coordinate */
-        int ry = (dy * rot_h) / dst_h;
+        int ry = ((screen_y - y) * rot_h) / dst_h;
         if (ry >= rot_h) ry = rot_h - 1;
 
-        for (int dx = 0; dx < dst_w; dx++) {
-            int screen_x = x + dx;
-            if (screen_x < 0 || screen_x >= logical_width) continue;
-
-            int rx = (dx * rot_w) / dst_w;
+        for (int screen_x = x1; screen_x < x2; screen_x++) {
+            int rx = ((screen_x - x) * rot_w) / dst_w;
             if (rx >= rot_w) rx = rot_w - 1;
 
             /* Map rotated coords back to original image coords */
@@ -1945,11 +4579,11 @@ void pager_draw_image_scaled_rotated(int x, int y, int dst_w, int dst_h,
                 uint8_t a = img->alpha[src_idx];
                 if (a == 0) continue;
                 if (a < 255) {
-                    color = blend_rgb565(color, read_pixel(screen_x, screen_y), a);
+                    color = blend_rgb565(color, peek_pixel(screen_x, screen_y), a);
                 }
             }
 
-            pager_set_pixel(screen_x, screen_y, color);
+            put_pixel(screen_x, screen_y, color);
         }
     }
 }
@@ -1967,6 +4601,213 @@ int pager_draw_image_file_scaled_rotated(int x, int y, int dst_w, int dst_h,
     return 0;
 }
 
+/*
+ * ============================================================
+ * MASKS (1 bit per pixel)
+ * ============================================================
+ */
+
+/* Create a mask, copying rows of (width + 7) / 8 bytes from bits if given */
+pager_mask_t *pager_create_mask(int width, int height, const uint8_t *bits) {
+    if (width <= 0 || height <= 0 || width > 4096 || height > 4096) return NULL;
+
+    pager_mask_t *mask = malloc(sizeof(pager_mask_t));
+    if (!mask) return NULL;
+
+    mask->width = width;
+    mask->height = height;
+    mask->stride = (width + 7) / 8;
+    mask->bits = calloc(height, mask->stride);
+    if (!mask->bits) {
+        free(mask);
+        return NULL;
+    }
+    if (bits) memcpy(mask->bits, bits, (size_t)height * mask->stride);
+    return mask;
+}
+
+/* Load an image as a mask: a pixel is set where it is at least half
+ * opaque or, for images without alpha, at least half bright */
+pager_mask_t *pager_load_mask(const char *filepath) {
+    if (!filepath) return NULL;
+
+    int width, height, channels;
+    if (!stbi_info(filepath, &width, &height, &channels)) {
+        fprintf(stderr, "Failed to load image: %s\n", filepath);
+        return NULL;
+    }
+    int has_alpha = (channels == 2 || channels == 4);
+
+    unsigned char *data = stbi_load(filepath, &width, &height, &channels, 4);
+    if (!data) {
+        fprintf(stderr, "Failed to load image: %s\n", filepath);
+        return NULL;
+    }
+
+    pager_mask_t *mask = pager_create_mask(width, height, NULL);
+    if (!mask) {
+        fprintf(stderr, "Image dimensions out of range: %dx%d\n", width, height);
+        stbi_image_free(data);
+        return NULL;
+    }
+
+    const unsigned char *px = data;
+    for (int y = 0; y < height; y++) {
+        uint8_t *row = mask->bits + y * mask->stride;
+        for (int x = 0; x < width; x++, px += 4) {
+            int on = has_alpha ? px[3] >= 128 : (px[0] * 77 + px[1] * 150 + px[2] * 29) >= 128 * 256;
+            if (on) row[x >> 3] |= 0x80 >> (x & 7);
+        }
+    }
+
+    stbi_image_free(data);
+    return mask;
+}
+
+void pager_free_mask(pager_mask_t *mask) {
+    if (mask) {
+        free(mask->bits);
+        free(mask);
+    }
+}
+
+/* Expand n mask bits, starting at bit `bit` of row, into fg/bg pixels,
+ * or with bg = PAGER_TRANSPARENT merge fg into the set pixels only.
+ * Once dst is word aligned each byte of mask becomes four word stores,
+ * looked up by bit pair: the pixel pair itself, or a select mask for
+ * (dst & ~sel) | (fg & sel). */
+static void mask_expand(uint16_t *dst, const uint8_t *row, int bit, int n, uint16_t fg, int bg) {
+    int merge = bg == PAGER_TRANSPARENT;
+    const uint16_t colors[2] = { merge ? 0 : (uint16_t)bg, merge ? 0xFFFF : fg };
+    uint32_t pairs[4];
+    for (int t = 0; t < 4; t++) {
+        uint16_t first = colors[t >> 1], second = colors[t & 1];
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+        pairs[t] = ((uint32_t)first << 16) | second;
+#else
+        pairs[t] = ((uint32_t)second << 16) | first;
+#endif
+    }
+    uint32_t fg_pair = ((uint32_t)fg << 16) | fg;
+
+    /* Bit reader: the next bits sit at the top of acc */
+    const uint8_t *src = row + (bit >> 3);
+    int bytes_left = ((bit & 7) + n + 7) / 8;
+    uint32_t acc = 0;
+    int avail = 0;
+    int skip = bit & 7;
+
+#define MASK_REFILL()                                            \
+    while (avail <= 24 && bytes_left > 0) {                      \
+        acc |= (uint32_t)*src++ << (24 - avail);                 \
+        avail += 8;                                              \
+        bytes_left--;                                            \
+    }
+#define MASK_PUT(p, t) \
+    (*(p) = merge ? (*(p) & ~pairs[t]) | (fg_pair & pairs[t]) : pairs[t])
+
+    MASK_REFILL();
+    acc <<= skip;
+    avail -= skip;
+
+    if (n > 0 && ((uintptr_t)dst & 2)) {
+        if (!merge || (acc >> 31)) *dst = (acc >> 31) ? fg : (uint16_t)bg;
+        dst++;
+        acc <<= 1;
+        avail--;
+        n--;
+    }
+
+    u32_alias_t *w = (u32_alias_t *)dst;
+    for (; n >= 8; n -= 8, w += 4) {
+        MASK_REFILL();
+        uint32_t b = acc >> 24;
+        acc <<= 8;
+        avail -= 8;
+        if (merge && b == 0x00) continue;
+        if (merge && b == 0xFF) {
+            w[0] = w[1] = w[2] = w[3] = fg_pair;
+            continue;
+        }
+        MASK_PUT(&w[0], b >> 6);
+        MASK_PUT(&w[1], (b >> 4) & 3);
+        MASK_PUT(&w[2], (b >> 2) & 3);
+        MASK_PUT(&w[3], b & 3);
+    }
+    MASK_REFILL();
+    for (; n >= 2; n -= 2) {
+        MASK_PUT(w, acc >> 30);
+        w++;
+        acc <<= 2;
+        avail -= 2;
+    }
+    dst = (uint16_t *)w;
+
+    if (n && (!merge || (acc >> 31))) *dst = (acc >> 31) ? fg : (uint16_t)bg;
+#undef MASK_PUT
+#undef MASK_REFILL
+}
+
+/* Emit the runs of set bits in bits [bit, bit + n) of row as spans,
+ * starting at logical pixel (x, y). Whole 0x00 and 0xFF bytes are taken
+ * at once. */
+static void mask_spans(const uint8_t *row, int bit, int n, int x, int y, uint16_t fg) {
+    int end = bit + n;
+    int run = -1;  /* Start of the current run of set bits */
+
+    for (int i = bit; i < end; ) {
+        uint8_t byte = row[i >> 3];
+        if ((i & 7) == 0 && end - i >= 8 && (byte == 0x00 || byte == 0xFF)) {
+            if (byte && run < 0) {
+                run = i;
+            } else if (!byte && run >= 0) {
+                span_fill(x + run - bit, x + i - bit, y, fg);
+                run = -1;
+            }
+            i += 8;
+            continue;
+        }
+
+        if (byte & (0x80 >> (i & 7))) {
+            if (run < 0) run = i;
+        } else if (run >= 0) {
+            span_fill(x + run - bit, x + i - bit, y, fg);
+            run = -1;
+        }
+        i++;
+    }
+
+    if (run >= 0) span_fill(x + run - bit, x + end - bit, y, fg);
+}
+
+/* Draw a mask: set bits in fg, clear bits in bg or left alone */
+void pager_draw_mask(int x, int y, const pager_mask_t *mask, uint16_t fg, int bg) {
+    if (!mask || !mask->bits || !framebuffer) return;
+
+    int x1 = x, y1 = y, x2 = x + mask->width, y2 = y + mask->height;
+    if (!clip_rect(&x1, &y1, &x2, &y2)) return;
+
+    damage_rect(x1, y1, x2, y2);
+
+    /* Rotated opaque rows are expanded here, then copied along the row */
+    uint32_t tmp[(MAX(PAGER_FB_WIDTH, PAGER_FB_HEIGHT) + 1) / 2];
+    if (bg != PAGER_TRANSPARENT) bg &= 0xFFFF;
+
+    for (int sy = y1; sy < y2; sy++) {
+        const uint8_t *row = mask->bits + (sy - y) * mask->stride;
+        int bit = x1 - x;
+
+        if (draw_linear()) {
+            mask_expand(draw_row(sy) + x1, row, bit, x2 - x1, fg, bg);
+        } else if (bg == PAGER_TRANSPARENT) {
+            mask_spans(row, bit, x2 - x1, x1, sy, fg);
+        } else {
+            mask_expand((uint16_t *)tmp, row, bit, x2 - x1, fg, bg);
+            span_copy(x1, x2, sy, (uint16_t *)tmp);
+        }
+    }
+}
+
 /*
  * ============================================================
  *  Screenshot
@@ -1999,22 +4840,42 @@ int pager_screenshot(const char *filepath, int rotation) {
         out_h = fb_h;  /* 480 */
     }
 
-    /* Read directly from hardware framebuffer */
-    int fd = open("/dev/fb0", O_RDONLY);
-    if (fd < 0) {
-        perror("pager_screenshot: failed to open /dev/fb0");
-        return -1;
-    }
-
     uint16_t *fb_data = malloc(fb_size);
-    if (!fb_data) {
+    if (!fb_data) return -1;
+
+    ssize_t bytes_read;
+    if (framebuffer && fb_mode == FB_MODE_MEMORY) {
+        /* Headless: what was last presented */
+        memcpy(fb_data, fb_map, fb_size);
+        bytes_read = fb_size;
+    } else if (framebuffer && fb_mode == FB_MODE_FILE) {
+        /* A pipe cannot be read back; the back buffer is the closest thing */
+        if (fb_stream) {
+            memcpy(fb_data, framebuffer, fb_size);
+            bytes_read = fb_size;
+        } else {
+            bytes_read = pread(fb_fd, fb_data, fb_size, 0);
+        }
+    } else {
+        /* Read directly from hardware framebuffer */
+        int fd = root_open(FB_DEVICE_PATH, O_RDONLY);
+        if (fd < 0) {
+            perror("pager_screenshot: failed to open /dev/fb0");
+            free(fb_data);
+            return -1;
+        }
+
+        /* If the display is page flipped, read the page being scanned out */
+        off_t offset = 0;
+        struct fb_var_screeninfo vinfo;
+        if (ioctl(fd, FBIOGET_VSCREENINFO, &vinfo) == 0) {
+            offset = (off_t)vinfo.yoffset * PAGER_STRIDE;
+        }
+
+        bytes_read = pread(fd, fb_data, fb_size, offset);
         close(fd);
-        return -1;
     }
 
-    ssize_t bytes_read = read(fd, fb_data, fb_size);
-    close(fd);
-
     if (bytes_read < (ssize_t)fb_size) {
         fprintf(stderr, "pager_screenshot: short read from fb0 (%zd/%zu)\n",
                 bytes_read, fb_size);
@@ -2029,8 +4890,14 @@ int pager_screenshot(const char *filepath, int rotation) {
         return -1;
     }
 
-    /* Convert RGB565 to RGB888 with rotation */
+    /* Convert RGB565 to RGB888 with rotation, one output row at a time */
+    uint16_t line[PAGER_FB_HEIGHT];
     for (int y = 0; y < out_h; y++) {
+        if (rotation == 0) {
+            kernels->rgb565_to_888(&rgb[y * out_w * 3], &fb_data[y * fb_w], out_w);
+            continue;
+        }
+
         for (int x = 0; x < out_w; x++) {
             /* Map output (x,y) back to framebuffer coords */
             int fx, fy;
@@ -2057,12 +4924,9 @@ int pager_screenshot(const char *filepath, int rotation) {
             if (fx >= 0 && fx < fb_w && fy >= 0 && fy < fb_h) {
                 px = fb_data[fy * fb_w + fx];
             }
-
-            int idx = (y * out_w + x) * 3;
-            rgb[idx + 0] = ((px >> 11) & 0x1F) << 3;  /* R */
-            rgb[idx + 1] = ((px >> 5) & 0x3F) << 2;   /* G */
-            rgb[idx + 2] = (px & 0x1F) << 3;           /* B */
+            line[x] = px;
         }
+        kernels->rgb565_to_888(&rgb[y * out_w * 3], line, out_w);
     }
 
     free(fb_data);
@@ -5,7 +5,7 @@
  *
  * Hardware Specs:
  *   Display: 222x480 pixels, RGB565 (16-bit color)
- *   Framebuffer: /dev/fb0 (direct write, no mmap needed)
+ *   Framebuffer: /dev/fb0 (mmap + page flip when the driver allows, else write)
  *   Refresh: ~20 FPS max (SPI bottleneck)
  *   Input: /dev/input/event0 (Linux evdev)
  *   CPU: MIPS 24KEc @ 580MHz, 64MB RAM
@@ -36,7 +36,7 @@
 #define PAGER_LANDSCAPE_WIDTH   480   /* Landscape logical width */
 #define PAGER_LANDSCAPE_HEIGHT  222   /* Landscape logical height */
 
-/* Target frame rate */
+/* Default target frame rate (change at runtime with pager_set_target_fps()) */
 #define PAGER_TARGET_FPS  20
 #define PAGER_FRAME_MS    (1000 / PAGER_TARGET_FPS)
 
@@ -137,6 +137,24 @@ typedef enum {
  */
 void pager_set_rotation(pager_rotation_t rotation);
 
+/* Render modes for pager_set_render_mode() */
+typedef enum {
+    PAGER_RENDER_DIRECT  = 0,  /* Draw into framebuffer order, rotating every pixel (default) */
+    PAGER_RENDER_LOGICAL = 1,  /* Draw in logical orientation, rotate once per flip */
+} pager_render_mode_t;
+
+/* Select how rotated drawing is done. In PAGER_RENDER_LOGICAL mode all
+ * primitives use their unrotated row fast paths on a logical-orientation
+ * buffer (e.g. 480x222 in landscape), and pager_flip() rotates the damaged
+ * area into the framebuffer with one cache-blocked pass. Costs one extra
+ * frame of memory while a rotation is active. Requires pager_init().
+ * Returns 0 on success, -1 on error.
+ */
+int pager_set_render_mode(pager_render_mode_t mode);
+
+/* Get the current render mode */
+pager_render_mode_t pager_get_render_mode(void);
+
 /* Get current logical screen width (depends on rotation) */
 int pager_get_width(void);
 
@@ -147,18 +165,60 @@ int pager_get_height(void);
  * Initialization and cleanup
  */
 
-/* Initialize the graphics system. Returns 0 on success, -1 on error. */
+/* Initialize the graphics system. Returns 0 on success, -1 on error.
+ * Options are taken from the environment:
+ *   PAGER_CALIBRATE=<frames>  time this many full-frame writes at startup
+ */
 int pager_init(void);
 
+/* Init options for pager_init_ex(). Zero-initialize, then set what you need. */
+typedef struct {
+    int calibrate_frames;   /* > 0: run pager_calibrate() with this many frames */
+    const char *display;    /* "fb" (default), "memory" or "file:<path>";
+                             * NULL = $PAGER_DISPLAY, else "fb" */
+    const char *device_root;/* Prefix for all /dev and /sys paths (fb, input,
+                             * buzzer, vibrator, LEDs, backlight), e.g. a fake
+                             * device tree; NULL = $PAGER_ROOT, else none */
+} pager_options_t;
+
+/* Initialize with explicit options (NULL = same as pager_init()).
+ *
+ * The "memory" and "file:<path>" displays need no Pager attached, so
+ * benchmarks and golden-image tests can run on a build host. A regular
+ * file is truncated to one frame and holds the latest raw RGB565 frame
+ * (222x480, little endian); a FIFO receives every presented frame in full.
+ * If the FIFO's reader exits, frames are dropped with a message on stderr;
+ * the process does not get SIGPIPE.
+ */
+int pager_init_ex(const pager_options_t *opts);
+
 /* Clean up and close framebuffer. Always call on exit. */
 void pager_cleanup(void);
 
+/* Name of the display path chosen by pager_init():
+ *   "fb-pan"   - drawing goes straight into video memory, flips use FBIOPAN_DISPLAY
+ *   "fb-mmap"  - private back buffer, damaged rows are copied into the mapped fb
+ *   "fb-write" - private back buffer, damaged rows are written to /dev/fb0
+ *   "memory"   - headless, frames are presented into a buffer in memory
+ *   "file"     - headless, frames are written to a file or FIFO
+ *   "none"     - not initialized
+ */
+const char *pager_get_backend(void);
+
 /*
  * Frame management
  */
 
-/* Flip the back buffer to the display. Call once per frame. */
-void pager_flip(void);
+/* Flip the back buffer to the display. Call once per frame.
+ * Only the row bands touched since the last flip are sent to /dev/fb0.
+ * If nothing was drawn since the last present, the device is not touched.
+ * Returns 1 if a frame was presented, 0 if the flip was elided.
+ */
+int pager_flip(void);
+
+/* Drawing generation: bumped by every drawing call. Compare two values
+ * to tell whether anything was drawn in between. */
+uint32_t pager_get_generation(void);
 
 /* Clear the screen to a solid color */
 void pager_clear(uint16_t color);
@@ -169,9 +229,185 @@ uint32_t pager_get_ticks(void);
 /* Sleep for specified milliseconds */
 void pager_delay(uint32_t ms);
 
-/* Frame rate limiter - call at end of game loop. Returns actual frame time. */
+/* Frame rate limiter - call at end of game loop. Returns actual frame time (ms).
+ * Sleeps until an absolute CLOCK_MONOTONIC deadline, so overshoot does not
+ * accumulate from frame to frame. */
 uint32_t pager_frame_sync(void);
 
+/* What pager_frame_sync() does when a frame misses its deadline */
+typedef enum {
+    PAGER_FRAME_SKIP    = 0,  /* Drop missed slots, stay on the frame grid (default) */
+    PAGER_FRAME_CATCHUP = 1,  /* Return at once so the next frames make up the time */
+} pager_frame_policy_t;
+
+/* Frame pacing report, updated by every pager_frame_sync() */
+typedef struct {
+    uint32_t frame_us;        /* Time between the last two frame_sync returns */
+    int32_t  late_us;         /* How far past its deadline the last frame arrived */
+    uint32_t frames;          /* Frames paced since the last reset */
+    uint32_t frames_late;     /* Frames that missed their deadline */
+    uint32_t frames_skipped;  /* Frame slots dropped by PAGER_FRAME_SKIP */
+} pager_frame_info_t;
+
+/* Set the late-frame policy */
+void pager_set_frame_policy(pager_frame_policy_t policy);
+
+/* Restart the frame schedule (e.g. after a pause) and zero the report */
+void pager_reset_frame_sync(void);
+
+/* Get the frame pacing report */
+void pager_get_frame_info(pager_frame_info_t *info);
+
+/* Set the target frame rate used by pager_frame_sync().
+ * fps <= 0 selects the rate measured by pager_calibrate() (or the default). */
+void pager_set_target_fps(int fps);
+
+/* Get the frame rate pager_frame_sync() is currently pacing to */
+int pager_get_target_fps(void);
+
+/* Display throughput measured by pager_calibrate() */
+typedef struct {
+    uint32_t frame_us;        /* Average time to present a full frame */
+    uint32_t row_call_us;     /* Average time to present a single row */
+    uint32_t bytes_per_sec;   /* Full-frame throughput */
+    uint32_t max_fps;         /* Achievable full-frame rate */
+} pager_calibration_t;
+
+/* Time `frames` full-frame writes (plus some single-row writes) to the
+ * display. The result tunes how partial flips merge nearby row bands and
+ * the rate used when the target FPS is 0. Sends the current back buffer,
+ * so call it before drawing. Returns 0 on success, -1 if not initialized.
+ */
+int pager_calibrate(int frames, pager_calibration_t *result);
+
+/* Get the last calibration result. Returns -1 if never calibrated. */
+int pager_get_calibration(pager_calibration_t *result);
+
+/*
+ * Row differencing and flip statistics
+ *
+ * With row differencing enabled, pager_flip() keeps a hash of every
+ * scanline it sent and skips damaged rows whose contents did not actually
+ * change. Code that clears and redraws the whole screen every frame then
+ * only sends the rows that differ. Rows forced with pager_damage_rect() or
+ * pager_damage_all() are always sent.
+ */
+
+typedef struct {
+    uint32_t frames_presented;  /* Flips that sent something to the display */
+    uint32_t rows_written;      /* Scanlines sent (including merged gaps) */
+    uint32_t rows_skipped;      /* Damaged scanlines dropped as unchanged */
+    uint64_t bytes_written;     /* Bytes sent to the display */
+    uint64_t bytes_saved;       /* Bytes not sent thanks to row differencing */
+    uint32_t frames_elided;     /* Flips skipped because nothing changed */
+} pager_flip_stats_t;
+
+/* Enable (1) or disable (0) row differencing (off by default) */
+void pager_set_row_diff(int enable);
+
+/* Returns 1 if row differencing is enabled */
+int pager_get_row_diff(void);
+
+/* Copy the flip counters into stats */
+void pager_get_flip_stats(pager_flip_stats_t *stats);
+
+/* Zero the flip counters */
+void pager_reset_flip_stats(void);
+
+/*
+ * Asynchronous flip
+ *
+ * When enabled, a presenter thread owns the device writes and pager_flip()
+ * returns as soon as the frame is queued, handing back a fresh back buffer
+ * that already holds the frame just submitted (three buffers rotate).
+ * If a new frame is flipped before the previous one was picked up, the
+ * older one is skipped. Not available with the "fb-pan" backend, which
+ * already presents without copying.
+ */
+
+/* Enable (1) or disable (0) asynchronous flipping. Disabling waits for the
+ * queued frame to reach the display. Returns 0 on success, -1 if unsupported. */
+int pager_set_async_flip(int enable);
+
+/* Returns 1 if asynchronous flipping is enabled */
+int pager_get_async_flip(void);
+
+/* Fence for the most recently flipped frame */
+uint32_t pager_flip_fence(void);
+
+/* Wait until the frame identified by fence is on the display.
+ * timeout_ms: 0 = poll, negative = wait forever.
+ * Returns 0 once presented, -1 on timeout.
+ */
+int pager_flip_wait(uint32_t fence, int timeout_ms);
+
+/*
+ * Damage tracking
+ *
+ * Every drawing primitive records the area it touched. pager_flip() sends
+ * only the damaged rows to the display and then clears the damage region.
+ */
+
+/* Mark a rectangle as changed so the next flip sends it (e.g. after
+ * writing pixels behind the library's back). */
+void pager_damage_rect(int x, int y, int w, int h);
+
+/* Force the next flip to send the whole frame */
+void pager_damage_all(void);
+
+/* Discard pending damage - the next flip sends nothing until more is drawn.
+ * With page flipping (PAN mode, async flip) the discarded rows are still
+ * copied between buffers on the next flip so they stay in sync. */
+void pager_clear_damage(void);
+
+/* Get the bounding box of the damage region in logical coordinates.
+ * Returns 1 if anything is damaged, 0 if the next flip would send nothing.
+ * Any output pointer may be NULL.
+ */
+int pager_get_damage(int *x, int *y, int *w, int *h);
+
+/*
+ * Clipping
+ *
+ * All drawing (including pager_clear()) is limited to the clip rectangle,
+ * in logical coordinates. Clips nest: a pushed rectangle is intersected
+ * with the current one and pager_pop_clip() restores the previous clip.
+ * pager_set_rotation() resets the clip to the full screen.
+ */
+
+/* Intersect the clip with a rectangle and save the old clip.
+ * Returns 0 on success, -1 if the stack (16 deep) is full.
+ */
+int pager_push_clip(int x, int y, int w, int h);
+
+/* Restore the clip saved by the matching pager_push_clip() */
+void pager_pop_clip(void);
+
+/* Drop all clips and draw to the full screen again */
+void pager_reset_clip(void);
+
+/* Get the current clip rectangle. Returns 0 if it is empty.
+ * Any output pointer may be NULL.
+ */
+int pager_get_clip(int *x, int *y, int *w, int *h);
+
+/*
+ * Pixel kernels
+ *
+ * Fills, image blits, alpha blending and pixel format conversion run on a
+ * kernel table picked by pager_init(): "dsp" (MIPS DSP ASE) when the CPU
+ * has it, otherwise "c" (portable). DSP blending may differ from the
+ * portable result by one LSB per channel.
+ */
+
+/* Select kernels by name: "c", "dsp", or NULL / "auto" for the best
+ * available. Returns 0 on success, -1 if not supported on this CPU.
+ */
+int pager_set_kernels(const char *name);
+
+/* Name of the kernel table in use */
+const char *pager_get_kernels(void);
+
 /*
  * Drawing primitives
  */
@@ -194,12 +430,119 @@ void pager_vline(int x, int y, int h, uint16_t color);
 /* Draw a line (Bresenham's algorithm) */
 void pager_draw_line(int x0, int y0, int x1, int y1, uint16_t color);
 
+/* Largest radius the filled circle, ellipse and rounded rectangle functions
+ * rasterize in exact integer arithmetic. Larger radii are still drawn,
+ * with each visible row's width worked out in floating point. */
+#define PAGER_MAX_RADIUS 16384
+
 /* Draw a filled circle */
 void pager_fill_circle(int cx, int cy, int r, uint16_t color);
 
 /* Draw a circle outline */
 void pager_draw_circle(int cx, int cy, int r, uint16_t color);
 
+/* Draw an anti-aliased line (Wu's algorithm), blended into the screen */
+void pager_draw_line_aa(int x0, int y0, int x1, int y1, uint16_t color);
+
+/* Draw an anti-aliased circle outline, blended into the screen. Radii
+ * above PAGER_MAX_RADIUS are drawn aliased, as by pager_draw_circle(). */
+void pager_draw_circle_aa(int cx, int cy, int r, uint16_t color);
+
+/* Draw a filled ellipse with horizontal radius rx and vertical radius ry */
+void pager_fill_ellipse(int cx, int cy, int rx, int ry, uint16_t color);
+
+/* Draw an ellipse outline */
+void pager_draw_ellipse(int cx, int cy, int rx, int ry, uint16_t color);
+
+/* Draw a filled rectangle with corners rounded to radius r (clamped so
+ * the corners fit) */
+void pager_fill_round_rect(int x, int y, int w, int h, int r, uint16_t color);
+
+/* Draw a rounded rectangle outline */
+void pager_draw_round_rect(int x, int y, int w, int h, int r, uint16_t color);
+
+/* Fill a rectangle with a linear gradient, top to bottom (vgradient) or
+ * left to right (hgradient). The end colours land on the first and last
+ * row or column. */
+void pager_fill_vgradient(int x, int y, int w, int h, uint16_t top, uint16_t bottom);
+void pager_fill_hgradient(int x, int y, int w, int h, uint16_t left, uint16_t right);
+
+/* Move the contents of a rectangle by (dx, dy) pixels, e.g. dy = -8 to
+ * scroll a log view up one line. Content moved past the edges is
+ * dropped and the uncovered strip is filled with fill; nothing outside
+ * the rectangle changes. Only the rectangle is damaged.
+ */
+void pager_scroll_region(int x, int y, int w, int h, int dx, int dy, uint16_t fill);
+
+/* Translucent fills: alpha 0 leaves the screen as is, 255 is opaque.
+ * Blending uses 32 alpha levels, as fine as a 5-bit channel can show.
+ * Dim the screen behind a popup with
+ * pager_fill_rect_alpha(0, 0, w, h, COLOR_BLACK, 128).
+ */
+void pager_fill_rect_alpha(int x, int y, int w, int h, uint16_t color, uint8_t alpha);
+void pager_hline_alpha(int x, int y, int w, uint16_t color, uint8_t alpha);
+void pager_fill_circle_alpha(int cx, int cy, int r, uint16_t color, uint8_t alpha);
+
+/* Point for polygon and batch functions */
+typedef struct {
+    int x;
+    int y;
+} pager_point_t;
+
+/* Largest coordinate (either sign) pager_fill_polygon(),
+ * pager_fill_triangle() and wide pager_draw_polyline() accept; a shape
+ * with a point beyond it draws nothing. Polyline widths are clamped to it. */
+#define PAGER_MAX_COORD 65536
+
+/* Draw a filled polygon (convex or not, even-odd rule). Pixels whose
+ * centers lie inside are filled, so the polygon (x,y) (x+w,y) (x+w,y+h)
+ * (x,y+h) covers exactly pager_fill_rect(x, y, w, h).
+ */
+void pager_fill_polygon(const pager_point_t *points, int n, uint16_t color);
+
+/* Draw a filled triangle */
+void pager_fill_triangle(int x0, int y0, int x1, int y1, int x2, int y2, uint16_t color);
+
+/* Draw connected line segments width pixels wide, centered on the
+ * points. Bends get miter joins, or round joins where the miter would
+ * stick out more than 4 half widths; the ends are cut square at the end
+ * points. Width 1 draws the same pixels as pager_draw_line().
+ */
+void pager_draw_polyline(const pager_point_t *points, int n, int width, uint16_t color);
+
+/*
+ * Batched drawing: many primitives in one call. Each draws exactly what
+ * the matching single-shape function would, in array order.
+ */
+
+typedef struct {
+    int x, y, w, h;
+    uint16_t color;
+} pager_rect_t;
+
+typedef struct {
+    int x0, y0, x1, y1;
+    uint16_t color;
+} pager_line_t;
+
+typedef struct {
+    int cx, cy, r;
+    uint16_t color;
+} pager_circle_t;
+
+/* Set n pixels, points[i] to colors[i]. Damage is the bounding box of
+ * the points inside the clip rectangle. */
+void pager_set_pixels(const pager_point_t *points, const uint16_t *colors, int n);
+
+/* Draw n filled rectangles */
+void pager_fill_rects(const pager_rect_t *rects, int n);
+
+/* Draw n lines */
+void pager_draw_lines(const pager_line_t *lines, int n);
+
+/* Draw n circles, filled when filled != 0, outlines otherwise */
+void pager_draw_circles(const pager_circle_t *circles, int n, int filled);
+
 /*
  * Text rendering (built-in 5x7 bitmap font)
  */
@@ -553,8 +896,42 @@ void pager_draw_image_scaled_rotated(int x, int y, int dst_w, int dst_h,
 int pager_draw_image_file_scaled_rotated(int x, int y, int dst_w, int dst_h,
                                          const char *filepath, int rotation);
 
+/* 1-bit-per-pixel bitmap for icons and other single-colour shapes.
+ * Rows are stride bytes apart, most significant bit first: bit 7 of
+ * bits[0] is the top-left pixel. A 32x32 icon takes 128 bytes.
+ */
+typedef struct {
+    int width;
+    int height;
+    int stride;     /* Bytes per row */
+    uint8_t *bits;  /* 1 = set */
+} pager_mask_t;
+
+/* Pass as bg to pager_draw_mask() to leave clear bits untouched */
+#define PAGER_TRANSPARENT (-1)
+
+/* Create a mask with rows of (width + 7) / 8 bytes, copied from bits
+ * (or all clear if bits is NULL). Free with pager_free_mask().
+ */
+pager_mask_t *pager_create_mask(int width, int height, const uint8_t *bits);
+
+/* Load an image file as a mask. A pixel is set where the image is at
+ * least half opaque or, without alpha, at least half bright.
+ * Returns NULL on error. Free with pager_free_mask().
+ */
+pager_mask_t *pager_load_mask(const char *filepath);
+
+/* Free a mask */
+void pager_free_mask(pager_mask_t *mask);
+
+/* Draw a mask at (x, y): set bits in fg, clear bits in bg (an RGB565
+ * colour) or, with bg = PAGER_TRANSPARENT, not at all.
+ */
+void pager_draw_mask(int x, int y, const pager_mask_t *mask, uint16_t fg, int bg);
+
 /* Save the hardware display to a PNG or BMP file.
- * Reads directly from /dev/fb0 — captures whatever is on screen.
+ * Reads directly from /dev/fb0 — captures whatever is on screen (or the
+ * last presented frame of a "memory"/"file" display).
  * Does not require pager_init(). Format determined by extension.
  * rotation: 0 = raw portrait (222x480), 270 = landscape (480x222).
  * Returns 0 on success, -1 on error.